@@ -1,11 +1,26 @@
 #include <xc.h>
+#include <stddef.h>
 #include "Buzzer.h"
+#include "Comandos.h"
+#include "Timer.h"
 
 #define LONGITUD 26
 
-static int ms = 0;
-static int note = 0;
-static int suena = 0;
+// Las notas se cambian en la ISR del Timer1, con su alarma (programarAlarma()):
+// no esperan a que el planificador termine lo que esté haciendo, como dibujar
+// en el TFT, y dormirHasta() despierta justo al final de cada una. Los finales
+// se cuentan desde el principio de la melodía, así que los retrasos de un
+// tick no se acumulan.
+static volatile int note = 0;
+static uint32_t fin_nota;
+
+static void comandoMelodia(int32_t arg);
+static void comandoPararMelodia(int32_t arg);
+
+static const comando_t comandos_buzzer[] = {
+    {"Melodia", ARG_NINGUNO, 0, 0, comandoMelodia, "Reproduce la melodia", NULL},
+    {"Parar Melodia", ARG_NINGUNO, 0, 0, comandoPararMelodia, "Detiene la melodia", NULL},
+};
 
 static const int partitura[LONGITUD] = {
     MI, SOL, LA, SOL, MI, SILENCIO,
@@ -27,27 +42,7 @@ void InicializarBuzzer(void) {
     RPB3R = 5;
     SYSKEY = 0x1CA11CA1;
 
-    T4CON = 0;
-    TMR4 = 0;
-    PR4 = 4999;
-    IFS0bits.T4IF = 0;
-    IEC0bits.T4IE = 1;
-    IPC4bits.T4IP = 6;
-    IPC4bits.T4IS = 3;
-}
-
-static void resetMilis(void) {
-    asm("di");
-    ms = 0;
-    asm("ei");
-}
-
-static int GetMilis(void) {
-    int copia_ms;
-    asm("di");
-    copia_ms = ms;
-    asm("ei");
-    return copia_ms;
+    registrarComandos(comandos_buzzer, sizeof(comandos_buzzer) / sizeof(comandos_buzzer[0]));
 }
 
 static void setNota(int f_nota) {
@@ -67,28 +62,36 @@ static void setNota(int f_nota) {
     }
 }
 
+// Se ejecuta en la ISR del Timer1
+static void finNota(void) {
+    note++;
+    if (note >= LONGITUD) {
+        setNota(SILENCIO);
+        return;
+    }
+    setNota(partitura[note]);
+    fin_nota += duracion[note];
+    programarAlarma(fin_nota, finNota);
+}
+
+// Necesita el Timer1 en marcha (InicializarTimer()), nada más.
 void reproducirMelodia(void) {
-    resetMilis();
+    cancelarAlarma(); // Si ya sonaba, la ISR deja de tocar note y fin_nota
     note = 0;
     setNota(partitura[note]);
-    suena = 1;
-    T4CON |= 0x8000;
+    fin_nota = getTiempoAbsoluto() + duracion[note];
+    programarAlarma(fin_nota, finNota);
 }
 
-void __attribute__((vector(16), interrupt(IPL6SOFT), nomips16)) InterrupcionTimer4(void) {
-    IFS0bits.T4IF = 0;
-    ms++;
-
-    if (suena && GetMilis() >= duracion[note]) {
-        resetMilis();
-        note++;
-        if (note >= LONGITUD) {
-            T3CON = 0;
-            OC1CON = 0;
-            T4CON = 0;
-            suena = 0;
-        } else {
-            setNota(partitura[note]);
-        }
-    }
+void pararMelodia(void) {
+    cancelarAlarma();
+    setNota(SILENCIO);
+}
+
+static void comandoMelodia(int32_t arg) {
+    reproducirMelodia();
+}
+
+static void comandoPararMelodia(int32_t arg) {
+    pararMelodia();
 }
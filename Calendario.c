@@ -0,0 +1,331 @@
+#ifdef __XC32
+#include <xc.h>
+#else
+#include <time.h>
+#endif
+#include <stdint.h>
+#include <stddef.h>
+#include "Calendario.h"
+#include "Comandos.h"
+#include "Uart.h"
+#include "Formato.h"
+#include "Timer.h"
+
+#define ANIO_BASE 2000
+#define SABADO 6 // Día de la semana del 1 de enero de 2000
+
+static const uint8_t dias_mes[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+static const char *const nombres_dia[7] = {
+    "domingo", "lunes", "martes", "miercoles", "jueves", "viernes", "sabado"
+};
+
+static void comandoFecha(int32_t arg);
+static resultado_cmd_t comandoAjustarFecha(const char *arg);
+static void comandoAjustarHora(int32_t hhmm);
+static void comandoCalibrar(int32_t ajuste);
+
+static const comando_t comandos_calendario[] = {
+    {"Fecha", ARG_NINGUNO, 0, 0, comandoFecha, "Muestra fecha, dia de la semana y hora", NULL},
+    {"Ajustar Fecha", ARG_TEXTO, 0, 0, NULL, "aaaa-mm-dd hh:mm[:ss]", comandoAjustarFecha},
+    {"Ajustar Hora", ARG_HORA, 0, 2359, comandoAjustarHora, "Pone el reloj en hhmm:00 (por difusion sincroniza el bus)", NULL},
+    {"Calibrar Reloj", ARG_ENTERO, -511, 511, comandoCalibrar,
+     "Correccion del RTCC en pulsos por minuto (1 = 0,51 ppm)", NULL},
+};
+
+static int diasDelMes(int anio, int mes) {
+    // Entre 2000 y 2099 es bisiesto todo año múltiplo de 4
+    return (mes == 2 && anio % 4 == 0) ? 29 : dias_mes[mes - 1];
+}
+
+static uint32_t diasDesdeBase(int anio, int mes, int dia) {
+    uint32_t dias = (anio - ANIO_BASE) * 365 + (anio - ANIO_BASE + 3) / 4;
+    int m;
+
+    for (m = 1; m < mes; m++) {
+        dias += diasDelMes(anio, m);
+    }
+    return dias + dia - 1;
+}
+
+static int esFechaValida(const fecha_t *f) {
+    return f->anio >= ANIO_BASE && f->anio <= ANIO_BASE + 99 &&
+           f->mes >= 1 && f->mes <= 12 &&
+           f->dia >= 1 && f->dia <= diasDelMes(f->anio, f->mes) &&
+           f->h >= 0 && f->h <= 23 && f->m >= 0 && f->m <= 59 &&
+           f->s >= 0 && f->s <= 59;
+}
+
+#ifdef __XC32
+
+// Registros del RTCC en BCD: RTCTIME hh:mm:ss:-- y RTCDATE aa:mm:dd:ds
+#define RTCCON_ON       (1u << 15)
+#define RTCCON_RTCWREN  (1u << 3)
+#define RTCALRM_ALRMEN  (1u << 15)
+#define RTCALRM_CHIME   (1u << 14)
+#define RTCALRM_MINUTO  (3u << 8)  // AMASK: una alarma por minuto, en el segundo 00
+
+static uint8_t desdeBcd(uint32_t v) {
+    v &= 0xFF;
+    return (v >> 4) * 10 + (v & 0xF);
+}
+
+static uint32_t aBcd(int v) {
+    return ((v / 10) << 4) | (v % 10);
+}
+
+static void permitirEscritura(int permitir) {
+    SYSKEY = 0xAA996655;
+    SYSKEY = 0x556699AA;
+    if (permitir) {
+        RTCCONSET = RTCCON_RTCWREN;
+    } else {
+        RTCCONCLR = RTCCON_RTCWREN;
+    }
+    SYSKEY = 0x1CA11CA1;
+}
+
+// Los registros cambian solos: se leen hasta obtener dos lecturas iguales.
+static void leerRtcc(fecha_t *f) {
+    uint32_t hora, fecha;
+
+    do {
+        hora = RTCTIME;
+        fecha = RTCDATE;
+    } while (hora != RTCTIME || fecha != RTCDATE);
+
+    f->anio = ANIO_BASE + desdeBcd(fecha >> 24);
+    f->mes = desdeBcd(fecha >> 16);
+    f->dia = desdeBcd(fecha >> 8);
+    f->dia_semana = fecha & 0x7;
+    f->h = desdeBcd(hora >> 24);
+    f->m = desdeBcd(hora >> 16);
+    f->s = desdeBcd(hora >> 8);
+}
+
+static void escribirRtcc(const fecha_t *f) {
+    permitirEscritura(1);
+    RTCCONCLR = RTCCON_ON;
+    while (RTCCONbits.RTCCLKON);
+    RTCTIME = (aBcd(f->h) << 24) | (aBcd(f->m) << 16) | (aBcd(f->s) << 8);
+    RTCDATE = (aBcd(f->anio - ANIO_BASE) << 24) | (aBcd(f->mes) << 16) |
+              (aBcd(f->dia) << 8) | f->dia_semana;
+    RTCCONSET = RTCCON_ON;
+    permitirEscritura(0);
+}
+
+// Tras un reset el RTCC sigue en marcha con la hora buena; solo se pone en
+// hora si está parado o tiene una fecha imposible (arranque en frío).
+static void arrancarRtcc(void) {
+    fecha_t f;
+
+    permitirEscritura(1);
+    RTCALRM = 0;
+    ALRMTIME = 0;
+    RTCALRM = RTCALRM_CHIME | RTCALRM_MINUTO;
+    RTCALRMSET = RTCALRM_ALRMEN;
+    permitirEscritura(0);
+
+    leerRtcc(&f);
+    if (!(RTCCON & RTCCON_ON) || !esFechaValida(&f)) {
+        f.anio = ANIO_BASE;
+        f.mes = 1;
+        f.dia = 1;
+        f.h = f.m = f.s = 0;
+        setFecha(&f);
+    }
+
+    IPC7bits.RTCCIP = 6; // Por debajo del Timer1
+    IPC7bits.RTCCIS = 0;
+    IFS0bits.RTCCIF = 0;
+    IEC0bits.RTCCIE = 1;
+}
+
+// Corrección de hasta ±511 pulsos por minuto. Se escribe fuera de la ventana
+// de sincronización del segundo para no perder el cambio.
+static void calibrarRtcc(int ajuste) {
+    permitirEscritura(1);
+    while (RTCCONbits.RTCSYNC);
+    RTCCONbits.CAL = ajuste;
+    permitirEscritura(0);
+}
+
+static int osciladorEnMarcha(void) {
+    return OSCCONbits.SOSCRDY;
+}
+
+// Alarma del segundo 00 de cada minuto: justo en el flanco del segundo se
+// corrige la deriva de la hora en RAM, que va con el reloj principal.
+void __attribute__((vector(_RTCC_VECTOR), interrupt(IPL6SOFT), nomips16)) InterrupcionCalendario(void) {
+    uint32_t hora = RTCTIME;
+
+    sincronizarHora(desdeBcd(hora >> 24), desdeBcd(hora >> 16), desdeBcd(hora >> 8));
+    IFS0bits.RTCCIF = 0;
+}
+
+#else
+
+// Emulación: una fecha de referencia y el reloj del sistema desde entonces.
+static uint32_t dias_referencia = 0;
+static uint32_t segundos_referencia = 0;
+static time_t instante_referencia = 0;
+
+static void leerRtcc(fecha_t *f) {
+    uint32_t segundos = segundos_referencia + (uint32_t) (time(NULL) - instante_referencia);
+    uint32_t dias = dias_referencia + segundos / 86400;
+
+    segundos %= 86400;
+    f->h = segundos / 3600;
+    f->m = segundos / 60 % 60;
+    f->s = segundos % 60;
+    f->dia_semana = (dias + SABADO) % 7;
+    f->anio = ANIO_BASE;
+    while (dias >= (uint32_t) (f->anio % 4 == 0 ? 366 : 365)) {
+        dias -= f->anio % 4 == 0 ? 366 : 365;
+        f->anio++;
+    }
+    f->mes = 1;
+    while (dias >= (uint32_t) diasDelMes(f->anio, f->mes)) {
+        dias -= diasDelMes(f->anio, f->mes);
+        f->mes++;
+    }
+    f->dia = dias + 1;
+}
+
+static void escribirRtcc(const fecha_t *f) {
+    dias_referencia = diasDesdeBase(f->anio, f->mes, f->dia);
+    segundos_referencia = f->h * 3600 + f->m * 60 + f->s;
+    instante_referencia = time(NULL);
+}
+
+static void arrancarRtcc(void) {
+    instante_referencia = time(NULL);
+}
+
+static void calibrarRtcc(int ajuste) {
+}
+
+static int osciladorEnMarcha(void) {
+    return 1;
+}
+
+#endif
+
+void InicializarCalendario(void) {
+    fecha_t f;
+
+    arrancarRtcc();
+    leerRtcc(&f);
+    setHoraActual(f.h, f.m, f.s);
+
+    registrarComandos(comandos_calendario, sizeof(comandos_calendario) / sizeof(comandos_calendario[0]));
+}
+
+void getFecha(fecha_t *fecha) {
+    leerRtcc(fecha);
+}
+
+int getDiaSemana(void) {
+    fecha_t f;
+
+    leerRtcc(&f);
+    return f.dia_semana;
+}
+
+// El día de la semana se calcula; el de la fecha recibida se ignora.
+// Devuelve 0 si la fecha no es válida.
+int setFecha(const fecha_t *fecha) {
+    fecha_t f = *fecha;
+
+    if (!esFechaValida(&f)) {
+        return 0;
+    }
+    f.dia_semana = (diasDesdeBase(f.anio, f.mes, f.dia) + SABADO) % 7;
+    escribirRtcc(&f);
+    setHoraActual(f.h, f.m, f.s);
+    return 1;
+}
+
+void setCalibracionCalendario(int ajuste) {
+    calibrarRtcc(ajuste);
+}
+
+static void comandoFecha(int32_t arg) {
+    char mensaje[64];
+    char *p;
+    fecha_t f;
+
+    getFecha(&f);
+    p = fmtCadena(mensaje, "Fecha: ");
+    p = fmtSinSigno(p, f.anio);
+    p = fmtCadena(p, "-");
+    p = fmtRelleno(p, f.mes, 2);
+    p = fmtCadena(p, "-");
+    p = fmtRelleno(p, f.dia, 2);
+    p = fmtCadena(p, " ");
+    p = fmtCadena(p, nombres_dia[f.dia_semana]);
+    p = fmtCadena(p, " ");
+    p = fmtHoraSeg(p, f.h, f.m, f.s);
+    if (!osciladorEnMarcha()) {
+        p = fmtCadena(p, " (sin oscilador de 32 kHz)");
+    }
+    p = fmtCadena(p, "\n\r");
+    writeUART(mensaje, p - mensaje);
+}
+
+// Lee un número de 'cifras' dígitos seguido de 'fin' (o de '\0' si fin es
+// '\0'). Devuelve el puntero tras el separador, o NULL.
+static const char *leerCampo(const char *p, int cifras, char fin, int *valor) {
+    int v = 0;
+
+    while (cifras-- > 0) {
+        if (*p < '0' || *p > '9') {
+            return NULL;
+        }
+        v = v * 10 + (*p++ - '0');
+    }
+    if (*p != fin) {
+        return NULL;
+    }
+    *valor = v;
+    return fin ? p + 1 : p;
+}
+
+static resultado_cmd_t comandoAjustarFecha(const char *arg) {
+    fecha_t f;
+    const char *p = arg;
+
+    while (*p == ' ') {
+        p++;
+    }
+    f.s = 0;
+    if (!(p = leerCampo(p, 4, '-', &f.anio)) ||
+        !(p = leerCampo(p, 2, '-', &f.mes)) ||
+        !(p = leerCampo(p, 2, ' ', &f.dia)) ||
+        !(p = leerCampo(p, 2, ':', &f.h))) {
+        return CMD_FORMATO;
+    }
+    if (!leerCampo(p, 2, '\0', &f.m)) {
+        if (!(p = leerCampo(p, 2, ':', &f.m)) || !leerCampo(p, 2, '\0', &f.s)) {
+            return CMD_FORMATO;
+        }
+    }
+    if (!setFecha(&f)) {
+        return CMD_RANGO;
+    }
+    comandoFecha(0);
+    return CMD_OK;
+}
+
+static void comandoAjustarHora(int32_t hhmm) {
+    fecha_t f;
+
+    getFecha(&f);
+    f.h = hhmm / 100;
+    f.m = hhmm % 100;
+    f.s = 0;
+    setFecha(&f);
+}
+
+static void comandoCalibrar(int32_t ajuste) {
+    setCalibracionCalendario(ajuste);
+}
@@ -0,0 +1,26 @@
+#ifndef CALENDARIO_H
+#define CALENDARIO_H
+
+// Reloj calendario sobre el RTCC, alimentado por el oscilador secundario de
+// 32,768 kHz: sigue contando aunque el reloj principal se reduzca o se pare,
+// y conserva fecha y hora tras un reset (no tras un corte de alimentación).
+// La hora en RAM de Timer.c se sincroniza con él al inicio de cada minuto.
+// Fuera del XC32 (compilación en el PC) el RTCC se emula con time().
+
+typedef struct {
+    int anio;       // 2000..2099
+    int mes, dia;   // 1..12, 1..31
+    int dia_semana; // 0 domingo .. 6 sábado, como el RTCC
+    int h, m, s;
+} fecha_t;
+
+// Máscaras de días de la semana: el bit n corresponde a dia_semana n
+#define DIAS_TODOS 0x7F
+
+void InicializarCalendario(void);
+void getFecha(fecha_t *fecha);
+int setFecha(const fecha_t *fecha);
+int getDiaSemana(void);
+void setCalibracionCalendario(int ajuste);
+
+#endif
@@ -0,0 +1,124 @@
+#include <stdint.h>
+#include <string.h>
+#include "Cola.h"
+
+void inicializarCola(cola_t *c, uint8_t *datos, uint32_t tam) {
+    c->icabeza = 0;
+    c->icola = 0;
+    c->mascara = tam - 1;
+    c->datos = datos;
+}
+
+uint32_t colaOcupada(const cola_t *c) {
+    return c->icabeza - c->icola;
+}
+
+uint32_t colaLibre(const cola_t *c) {
+    return c->mascara + 1 - (c->icabeza - c->icola);
+}
+
+// Devuelve el hueco contiguo disponible para escribir a partir de la cabeza.
+uint32_t colaTramoEscritura(cola_t *c, uint8_t **p) {
+    uint32_t cabeza = c->icabeza;
+    uint32_t libre = c->mascara + 1 - (cabeza - c->icola);
+    uint32_t hasta_fin = c->mascara + 1 - (cabeza & c->mascara);
+
+    *p = &c->datos[cabeza & c->mascara];
+    return libre < hasta_fin ? libre : hasta_fin;
+}
+
+// Publica n bytes ya copiados en el tramo de escritura.
+void colaProducir(cola_t *c, uint32_t n) {
+    BARRERA_MEMORIA(); // Los datos han de estar escritos antes que el índice
+    c->icabeza += n;
+}
+
+// Devuelve el tramo contiguo de datos pendientes a partir de la cola.
+uint32_t colaTramoLectura(cola_t *c, uint8_t **p) {
+    uint32_t icola = c->icola;
+    uint32_t ocupado = c->icabeza - icola;
+    uint32_t hasta_fin = c->mascara + 1 - (icola & c->mascara);
+
+    BARRERA_MEMORIA(); // El índice se lee antes que los datos
+    *p = &c->datos[icola & c->mascara];
+    return ocupado < hasta_fin ? ocupado : hasta_fin;
+}
+
+// Libera n bytes ya leídos del tramo de lectura.
+void colaConsumir(cola_t *c, uint32_t n) {
+    BARRERA_MEMORIA(); // Los datos han de estar leídos antes de liberar el hueco
+    c->icola += n;
+}
+
+// Copia hasta n bytes en, como mucho, dos tramos. Devuelve los escritos.
+uint32_t colaEscribir(cola_t *c, const void *datos, uint32_t n) {
+    const uint8_t *origen = datos;
+    uint32_t escritos = 0;
+    int tramo;
+
+    for (tramo = 0; tramo < 2 && escritos < n; tramo++) {
+        uint8_t *p;
+        uint32_t hueco = colaTramoEscritura(c, &p);
+        uint32_t copia = n - escritos;
+
+        if (hueco == 0) {
+            break;
+        }
+        if (copia > hueco) {
+            copia = hueco;
+        }
+        memcpy(p, &origen[escritos], copia);
+        colaProducir(c, copia);
+        escritos += copia;
+    }
+    return escritos;
+}
+
+int colaEscribirByte(cola_t *c, uint8_t dato) {
+    uint32_t cabeza = c->icabeza;
+
+    if (cabeza - c->icola > c->mascara) {
+        return 0;
+    }
+    c->datos[cabeza & c->mascara] = dato;
+    BARRERA_MEMORIA();
+    c->icabeza = cabeza + 1;
+    return 1;
+}
+
+// Copia hasta n bytes en, como mucho, dos tramos. Devuelve los leídos.
+uint32_t colaLeer(cola_t *c, void *datos, uint32_t n) {
+    uint8_t *destino = datos;
+    uint32_t leidos = 0;
+    int tramo;
+
+    for (tramo = 0; tramo < 2 && leidos < n; tramo++) {
+        uint8_t *p;
+        uint32_t disponible = colaTramoLectura(c, &p);
+        uint32_t copia = n - leidos;
+
+        if (disponible == 0) {
+            break;
+        }
+        if (copia > disponible) {
+            copia = disponible;
+        }
+        memcpy(&destino[leidos], p, copia);
+        colaConsumir(c, copia);
+        leidos += copia;
+    }
+    return leidos;
+}
+
+int colaLeerByte(cola_t *c, uint8_t *dato) {
+    uint32_t icola = c->icola;
+
+    if (c->icabeza == icola) {
+        return 0;
+    }
+    BARRERA_MEMORIA();
+    *dato = c->datos[icola & c->mascara];
+    BARRERA_MEMORIA();
+    c->icola = icola + 1;
+    return 1;
+}
@@ -0,0 +1,42 @@
+#ifndef COLA_H
+#define COLA_H
+
+#include <stdint.h>
+
+// Cola circular de un solo productor y un solo consumidor (SPSC).
+// El tamaño ha de ser potencia de 2: los índices crecen libremente y se
+// enmascaran al acceder, de modo que lleno/vacío se distinguen sin perder
+// una posición. Cada índice lo escribe solo uno de los dos extremos, por lo
+// que ni el productor ni el consumidor necesitan deshabilitar interrupciones.
+
+typedef struct {
+    volatile uint32_t icabeza; // Lo escribe solo el productor
+    volatile uint32_t icola;   // Lo escribe solo el consumidor
+    uint32_t mascara;
+    uint8_t *datos;
+} cola_t;
+
+// Barrera de compilador: en el PIC32 (un solo núcleo, sin caché de datos)
+// basta con impedir que el compilador reordene los accesos a memoria.
+#define BARRERA_MEMORIA() __asm__ volatile("" ::: "memory")
+
+#define ES_POTENCIA_DE_2(n) ((n) != 0 && ((n) & ((n) - 1)) == 0)
+
+void inicializarCola(cola_t *c, uint8_t *datos, uint32_t tam);
+
+uint32_t colaOcupada(const cola_t *c);
+uint32_t colaLibre(const cola_t *c);
+
+// Extremo productor
+uint32_t colaEscribir(cola_t *c, const void *datos, uint32_t n);
+int colaEscribirByte(cola_t *c, uint8_t dato);
+uint32_t colaTramoEscritura(cola_t *c, uint8_t **p);
+void colaProducir(cola_t *c, uint32_t n);
+
+// Extremo consumidor
+uint32_t colaLeer(cola_t *c, void *datos, uint32_t n);
+int colaLeerByte(cola_t *c, uint8_t *dato);
+uint32_t colaTramoLectura(cola_t *c, uint8_t **p);
+void colaConsumir(cola_t *c, uint32_t n);
+
+#endif
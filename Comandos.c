@@ -0,0 +1,189 @@
+#include <stdint.h>
+#include <string.h>
+#include "Comandos.h"
+
+#if (MAX_COMANDOS & (MAX_COMANDOS - 1)) != 0
+#error "MAX_COMANDOS ha de ser potencia de 2"
+#endif
+
+// Falla al compilar si LINEA_MAS_LARGA, con su '\0', no cabe en MAX_LINEA
+typedef char linea_mas_larga_cabe[sizeof(LINEA_MAS_LARGA) <= MAX_LINEA ? 1 : -1];
+
+#define MAX_DIGITOS 9 // Cabe en un int32_t sin desbordar
+
+static const comando_t *tabla_hash[MAX_COMANDOS];
+static const comando_t *registrados[MAX_COMANDOS]; // En orden, para la ayuda
+static int num_comandos = 0;
+
+static char linea[MAX_LINEA];
+static int long_linea = 0;
+static int linea_desbordada = 0;
+
+// FNV-1a de 32 bits sobre los caracteres del nombre.
+static uint32_t hashNombre(const char *nombre, int longitud) {
+    uint32_t h = 2166136261u;
+    int i;
+
+    for (i = 0; i < longitud; i++) {
+        h ^= (uint8_t) nombre[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Devuelve el número de comandos registrados, o -1 si no caben. La tabla
+// nunca se llena del todo, para que toda búsqueda acabe en un hueco vacío.
+int registrarComandos(const comando_t tabla[], int n) {
+    int i;
+
+    if (num_comandos + n > MAX_COMANDOS - 1) {
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        int longitud = strlen(tabla[i].nombre);
+        uint32_t pos = hashNombre(tabla[i].nombre, longitud) & (MAX_COMANDOS - 1);
+
+        while (tabla_hash[pos] != NULL) {
+            pos = (pos + 1) & (MAX_COMANDOS - 1);
+        }
+        tabla_hash[pos] = &tabla[i];
+        registrados[num_comandos++] = &tabla[i];
+    }
+    return num_comandos;
+}
+
+const comando_t *buscarComando(const char *nombre, int longitud) {
+    uint32_t pos = hashNombre(nombre, longitud) & (MAX_COMANDOS - 1);
+
+    while (tabla_hash[pos] != NULL) {
+        const comando_t *cmd = tabla_hash[pos];
+
+        if (strncmp(cmd->nombre, nombre, longitud) == 0 &&
+            cmd->nombre[longitud] == '\0') {
+            return cmd;
+        }
+        pos = (pos + 1) & (MAX_COMANDOS - 1);
+    }
+    return NULL;
+}
+
+// A diferencia de atoi(), rechaza cualquier cosa que no sea un entero
+// decimal completo (con espacios alrededor) y no desborda.
+int leerEntero(const char *p, int32_t *valor) {
+    int32_t v = 0;
+    int negativo = 0;
+    int digitos = 0;
+
+    while (*p == ' ') {
+        p++;
+    }
+    if (*p == '-' || *p == '+') {
+        negativo = (*p == '-');
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+        if (++digitos > MAX_DIGITOS) {
+            return 0;
+        }
+        v = v * 10 + (*p - '0');
+        p++;
+    }
+    while (*p == ' ') {
+        p++;
+    }
+    if (digitos == 0 || *p != '\0') {
+        return 0;
+    }
+    *valor = negativo ? -v : v;
+    return 1;
+}
+
+int esHoraValida(int32_t hhmm) {
+    return hhmm >= 0 && hhmm / 100 <= 23 && hhmm % 100 <= 59;
+}
+
+// Valida el argumento contra el esquema del comando y lo ejecuta. La usan
+// tanto las líneas de texto como las tramas del protocolo binario.
+resultado_cmd_t ejecutarComando(const comando_t *cmd, int32_t arg) {
+    if (cmd->tipo == ARG_TEXTO) {
+        return CMD_FORMATO; // No tiene forma numérica
+    } else if (cmd->tipo == ARG_HORA) {
+        if (!esHoraValida(arg)) {
+            return CMD_RANGO;
+        }
+    } else if (cmd->tipo == ARG_ENTERO) {
+        if (arg < cmd->min || arg > cmd->max) {
+            return CMD_RANGO;
+        }
+    }
+
+    cmd->manejador(arg);
+    return CMD_OK;
+}
+
+resultado_cmd_t ejecutarLinea(const char *linea) {
+    const char *separador = strchr(linea, ':');
+    int longitud = separador ? separador - linea : (int) strlen(linea);
+    const comando_t *cmd;
+    int32_t arg = 0;
+
+    if (longitud == 0 && separador == NULL) {
+        return CMD_VACIO;
+    }
+    cmd = buscarComando(linea, longitud);
+    if (cmd == NULL) {
+        return CMD_DESCONOCIDO;
+    }
+
+    if (cmd->tipo == ARG_NINGUNO) {
+        if (separador != NULL) {
+            return CMD_FORMATO;
+        }
+    } else if (cmd->tipo == ARG_TEXTO) {
+        if (separador == NULL) {
+            return CMD_FORMATO;
+        }
+        return cmd->manejador_texto(separador + 1);
+    } else {
+        if (separador == NULL || !leerEntero(separador + 1, &arg)) {
+            return CMD_FORMATO;
+        }
+    }
+
+    return ejecutarComando(cmd, arg);
+}
+
+// Una línea demasiado larga se descarta entera: truncarla podría convertirla
+// en otro comando válido ("Peso:1234" -> "Peso:12").
+resultado_cmd_t recibirByteLinea(uint8_t c) {
+    resultado_cmd_t resultado;
+
+    if (c != '\n' && c != '\r') {
+        if (long_linea < MAX_LINEA - 1) {
+            linea[long_linea++] = c;
+        } else {
+            linea_desbordada = 1;
+        }
+        return CMD_VACIO;
+    }
+    linea[long_linea] = '\0';
+    resultado = linea_desbordada ? CMD_DEMASIADO_LARGA : ejecutarLinea(linea);
+    reiniciarLinea();
+    return resultado;
+}
+
+void reiniciarLinea(void) {
+    long_linea = 0;
+    linea_desbordada = 0;
+}
+
+int getNumComandos(void) {
+    return num_comandos;
+}
+
+const comando_t *getComando(int i) {
+    if (i < 0 || i >= num_comandos) {
+        return NULL;
+    }
+    return registrados[i];
+}
@@ -0,0 +1,62 @@
+#ifndef COMANDOS_H
+#define COMANDOS_H
+
+#include <stdint.h>
+
+// Registro de comandos de texto. Cada módulo registra una tabla constante
+// con sus comandos; las líneas tienen la forma "Nombre" o "Nombre:argumento".
+// La búsqueda es por hash del nombre, así que su coste depende solo de la
+// longitud del comando y no de cuántos haya registrados.
+
+#ifndef MAX_COMANDOS
+#define MAX_COMANDOS 64 // Capacidad de la tabla hash (potencia de 2)
+#endif
+#ifndef MAX_LINEA
+#define MAX_LINEA 64    // Incluido el '\0'
+#endif
+
+// La línea válida más larga: un Config con todos los campos
+#define LINEA_MAS_LARGA "Config:P=100;H1=0830;H2=1900;D1=LMXJVSD;D2=LMXJVSD;A=254"
+
+typedef enum {
+    ARG_NINGUNO, // Sin argumento
+    ARG_ENTERO,  // Entero decimal en [min, max]
+    ARG_HORA,    // hhmm, con hh < 24 y mm < 60. Se pasa como hh*100 + mm
+    ARG_TEXTO    // El texto tras ':' lo valida manejador_texto
+} tipo_arg_t;
+
+typedef enum {
+    CMD_OK = 0,
+    CMD_VACIO,       // Línea vacía, se ignora
+    CMD_DESCONOCIDO,
+    CMD_FORMATO,     // Argumento ausente, sobrante o no numérico
+    CMD_RANGO,       // Argumento fuera de rango
+    CMD_CONFLICTO,   // Valores válidos por separado pero incompatibles
+    CMD_DEMASIADO_LARGA // La línea no cabía en MAX_LINEA: no se ejecuta
+} resultado_cmd_t;
+
+typedef struct {
+    const char *nombre;
+    tipo_arg_t tipo;
+    int32_t min, max;
+    void (*manejador)(int32_t arg);
+    const char *ayuda;
+    resultado_cmd_t (*manejador_texto)(const char *arg); // Solo ARG_TEXTO
+} comando_t;
+
+int registrarComandos(const comando_t tabla[], int n);
+const comando_t *buscarComando(const char *nombre, int longitud);
+resultado_cmd_t ejecutarComando(const comando_t *cmd, int32_t arg);
+resultado_cmd_t ejecutarLinea(const char *linea);
+// Montaje de líneas byte a byte. Devuelve CMD_VACIO mientras la línea no
+// está completa. No toca el hardware, así que se puede compilar y probar en
+// el PC alimentándolo con bytes.
+resultado_cmd_t recibirByteLinea(uint8_t c);
+void reiniciarLinea(void);
+int leerEntero(const char *p, int32_t *valor);
+int esHoraValida(int32_t hhmm);
+
+int getNumComandos(void);
+const comando_t *getComando(int i);
+
+#endif
@@ -0,0 +1,56 @@
+#include <stdint.h>
+#include "Formato.h"
+
+#define MAX_DIGITOS 10 // 2^32 - 1 tiene 10 cifras
+
+char *fmtCadena(char *p, const char *s) {
+    while (*s != '\0') {
+        *p++ = *s++;
+    }
+    *p = '\0';
+    return p;
+}
+
+char *fmtRelleno(char *p, uint32_t v, int ancho) {
+    char cifras[MAX_DIGITOS];
+    int n = 0;
+
+    do {
+        cifras[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v != 0);
+
+    while (ancho > n) {
+        *p++ = '0';
+        ancho--;
+    }
+    while (n > 0) {
+        *p++ = cifras[--n];
+    }
+    *p = '\0';
+    return p;
+}
+
+char *fmtSinSigno(char *p, uint32_t v) {
+    return fmtRelleno(p, v, 0);
+}
+
+char *fmtEntero(char *p, int32_t v) {
+    if (v < 0) {
+        *p++ = '-';
+        return fmtSinSigno(p, -(uint32_t) v);
+    }
+    return fmtSinSigno(p, v);
+}
+
+char *fmtHora(char *p, int h, int m) {
+    p = fmtRelleno(p, h, 2);
+    *p++ = ':';
+    return fmtRelleno(p, m, 2);
+}
+
+char *fmtHoraSeg(char *p, int h, int m, int s) {
+    p = fmtHora(p, h, m);
+    *p++ = ':';
+    return fmtRelleno(p, s, 2);
+}
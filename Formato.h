@@ -0,0 +1,20 @@
+#ifndef FORMATO_H
+#define FORMATO_H
+
+#include <stdint.h>
+
+// Formateo de enteros sin printf. Todas las funciones escriben a partir de p,
+// terminan la cadena con '\0' y devuelven un puntero a ese '\0', de modo que
+// se pueden encadenar:
+//     p = fmtCadena(buf, "Peso: ");
+//     p = fmtEntero(p, peso);
+//     writeUART(buf, p - buf);
+
+char *fmtCadena(char *p, const char *s);
+char *fmtSinSigno(char *p, uint32_t v);
+char *fmtEntero(char *p, int32_t v);
+char *fmtRelleno(char *p, uint32_t v, int ancho);  // %0<ancho>u
+char *fmtHora(char *p, int h, int m);               // %02d:%02d
+char *fmtHoraSeg(char *p, int h, int m, int s);     // %02d:%02d:%02d
+
+#endif
@@ -1,8 +1,23 @@
 #include <xc.h>
 #include <stdint.h>
+#include <stddef.h>
+#include "Mascota.h"
+#include "Uart.h"
+#include "Comandos.h"
+#include "Formato.h"
 
 static uint32_t peso = 10;
 
+static void comandoRacion(int32_t arg);
+
+static const comando_t comandos_mascota[] = {
+    {"Racion", ARG_NINGUNO, 0, 0, comandoRacion, "Muestra la racion diaria", NULL},
+};
+
+void InicializarMascota(void){
+    registrarComandos(comandos_mascota, sizeof(comandos_mascota) / sizeof(comandos_mascota[0]));
+}
+
 uint32_t getPeso(void){
     return peso;
 }
@@ -36,3 +51,12 @@ uint32_t getRacion(void) {
     return racion;
 }
 
+static void comandoRacion(int32_t arg) {
+    char mensaje[40];
+    char *p;
+
+    p = fmtCadena(mensaje, "Racion diaria: ");
+    p = fmtSinSigno(p, getRacion() * 2);
+    p = fmtCadena(p, " g\n\r");
+    writeUART(mensaje, p - mensaje);
+}
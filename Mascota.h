@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 
+void InicializarMascota(void);
 uint32_t getPeso(void);
 void setPeso(uint32_t peso_kg);
 uint32_t getRacion(void);
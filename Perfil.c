@@ -0,0 +1,146 @@
+#include <xc.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "Perfil.h"
+#include "Comandos.h"
+#include "Uart.h"
+#include "Formato.h"
+#include "SeccionCritica.h"
+#if COMPARAR_SPRINTF
+#include <stdio.h>
+#endif
+
+typedef struct {
+    uint32_t llamadas;
+    uint32_t min, max;
+    uint64_t total; // A 20 MHz, 32 bits se desbordarían en 3,5 minutos
+} estadistica_perfil_t;
+
+// Cada zona se mide siempre desde el mismo contexto (programa principal o una
+// ISR concreta), así que nadie más escribe su entrada a la vez. Para leerla o
+// borrarla desde el programa principal basta subir el IPL al de esa ISR.
+static estadistica_perfil_t perfiles[NUM_PERFILES];
+
+static const uint8_t techo_perfil[NUM_PERFILES] = {
+    0, 0, 0, 0, IPL_UART, IPL_TIMER1, 0,
+    IPL_TIMER1, 0, 0, 0, 0
+};
+
+static const char *const nombres_perfil[NUM_PERFILES] = {
+    "SPI_SendFrame", "printChar", "drawBitmap", "clrScr",
+    "ISR UART1", "ISR Timer1", "Planificador",
+    "Entrada ISR Timer1", "Salida ISR Timer1", "Despertar", "fmt*", "sprintf"
+};
+
+static void comandoPerfil(int32_t arg);
+static void comandoBorrarPerfil(int32_t arg);
+#if COMPARAR_SPRINTF
+static void comandoCompararFormato(int32_t arg);
+#endif
+
+static const comando_t comandos_perfil[] = {
+    {"Perfil", ARG_NINGUNO, 0, 0, comandoPerfil, "Llamadas y ciclos (50 ns) por zona medida", NULL},
+    {"Borrar Perfil", ARG_NINGUNO, 0, 0, comandoBorrarPerfil, "Pone a cero la tabla de perfilado", NULL},
+#if COMPARAR_SPRINTF
+    {"Comparar Formato", ARG_ENTERO, 1, 1000, comandoCompararFormato, "Mide fmt* y sprintf con el mismo mensaje", NULL},
+#endif
+};
+
+void InicializarPerfil(void) {
+    borrarPerfil();
+    registrarComandos(comandos_perfil, sizeof(comandos_perfil) / sizeof(comandos_perfil[0]));
+}
+
+uint32_t getCiclos(void) {
+    return _CP0_GET_COUNT();
+}
+
+void acumularPerfil(zona_perfil_t zona, uint32_t ciclos) {
+    estadistica_perfil_t *e = &perfiles[zona];
+
+    e->llamadas++;
+    e->total += ciclos;
+    if (ciclos < e->min) {
+        e->min = ciclos;
+    }
+    if (ciclos > e->max) {
+        e->max = ciclos;
+    }
+}
+
+void borrarPerfil(void) {
+    int i;
+
+    for (i = 0; i < NUM_PERFILES; i++) {
+        uint32_t estado = entrarSeccionCritica(techo_perfil[i]);
+
+        perfiles[i].llamadas = 0;
+        perfiles[i].min = 0xFFFFFFFF;
+        perfiles[i].max = 0;
+        perfiles[i].total = 0;
+        salirSeccionCritica(estado);
+    }
+}
+
+// Formato como el de "Ayuda": una línea por zona con campos separados por ';'
+static void comandoPerfil(int32_t arg) {
+    char mensaje[96];
+    char *p;
+    int i;
+
+    putsUART("#zona;llamadas;min;media;max;total_us\n\r");
+    for (i = 0; i < NUM_PERFILES; i++) {
+        estadistica_perfil_t e;
+        uint32_t estado;
+
+        // Copia coherente: las zonas de las ISR pueden cambiar a mitad
+        estado = entrarSeccionCritica(techo_perfil[i]);
+        e = perfiles[i];
+        salirSeccionCritica(estado);
+
+        p = fmtCadena(mensaje, nombres_perfil[i]);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.llamadas);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.llamadas ? e.min : 0);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.llamadas ? (uint32_t) (e.total / e.llamadas) : 0);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.max);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, (uint32_t) (e.total / CICLOS_POR_US));
+        p = fmtCadena(p, "\n\r");
+        writeUART(mensaje, p - mensaje);
+    }
+}
+
+static void comandoBorrarPerfil(int32_t arg) {
+    borrarPerfil();
+}
+
+#if COMPARAR_SPRINTF
+// El mensaje cambia en cada vuelta para que no se pueda precalcular
+static void comandoCompararFormato(int32_t arg) {
+    char buffer[32];
+    int32_t i;
+
+    for (i = 0; i < arg; i++) {
+        char *p;
+        PERFIL_INICIO(PERFIL_FMT);
+
+        p = fmtHoraSeg(buffer, 12, 34, i % 60);
+        p = fmtCadena(p, " Peso: ");
+        p = fmtEntero(p, -1234 - i);
+        fmtCadena(p, "\n\r");
+
+        PERFIL_FIN(PERFIL_FMT);
+    }
+    for (i = 0; i < arg; i++) {
+        PERFIL_INICIO(PERFIL_SPRINTF);
+
+        sprintf(buffer, "%02d:%02d:%02d Peso: %d\n\r", 12, 34, (int) (i % 60), (int) (-1234 - i));
+
+        PERFIL_FIN(PERFIL_SPRINTF);
+    }
+}
+#endif
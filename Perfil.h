@@ -0,0 +1,63 @@
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include <stdint.h>
+
+// Perfilado con el registro Count del CP0, que avanza a SYSCLK/2 (20 MHz,
+// 50 ns por ciclo). Cada zona acumula llamadas y ciclos totales, mínimos y
+// máximos; el comando "Perfil" vuelca la tabla por la UART.
+//
+//     PERFIL_INICIO(PERFIL_SPI);
+//     ...
+//     PERFIL_FIN(PERFIL_SPI);
+//
+// Las dos macros van en el mismo bloque. PERFIL_MUESTRA(zona, ciclos) anota
+// una medida tomada de otra forma, como las latencias de las ISR. El tiempo de una zona incluye el de
+// las interrupciones que la interrumpan. Con -DPERFIL_ACTIVO=0 desaparecen.
+//
+// Con -DCOMPARAR_SPRINTF=1 el comando "Comparar Formato:n" compone n veces el
+// mismo mensaje con fmt* y con sprintf, en las zonas PERFIL_FMT y
+// PERFIL_SPRINTF. Por defecto no se compila, para no enlazar stdio.
+
+#ifndef PERFIL_ACTIVO
+#define PERFIL_ACTIVO 1
+#endif
+
+#ifndef COMPARAR_SPRINTF
+#define COMPARAR_SPRINTF 0
+#endif
+
+#define CICLOS_POR_US 20 // Count a SYSCLK/2
+
+typedef enum {
+    PERFIL_SPI,          // SPI_SendFrame
+    PERFIL_PRINT_CHAR,
+    PERFIL_DRAW_BITMAP,
+    PERFIL_CLR_SCR,
+    PERFIL_ISR_UART,
+    PERFIL_ISR_TIMER1,
+    PERFIL_PLANIFICADOR, // Temporizadores y un despacho, sin el reposo
+    PERFIL_ENTRADA_TIMER1, // Del vencimiento del periodo a la ISR (TMR1)
+    PERFIL_SALIDA_TIMER1,  // Del final de la ISR a la vuelta del wait
+    PERFIL_DESPERTAR,      // De avisarTrabajo() en una ISR a la vuelta del wait
+    PERFIL_FMT,            // "hh:mm:ss Peso: n" con fmt*
+    PERFIL_SPRINTF,        // El mismo mensaje con sprintf
+    NUM_PERFILES
+} zona_perfil_t;
+
+#if PERFIL_ACTIVO
+#define PERFIL_INICIO(zona) uint32_t inicio_##zona = getCiclos()
+#define PERFIL_FIN(zona) acumularPerfil(zona, getCiclos() - inicio_##zona)
+#define PERFIL_MUESTRA(zona, ciclos) acumularPerfil(zona, ciclos)
+#else
+#define PERFIL_INICIO(zona)
+#define PERFIL_FIN(zona)
+#define PERFIL_MUESTRA(zona, ciclos)
+#endif
+
+void InicializarPerfil(void);
+uint32_t getCiclos(void);
+void acumularPerfil(zona_perfil_t zona, uint32_t ciclos);
+void borrarPerfil(void);
+
+#endif
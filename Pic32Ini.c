@@ -8,6 +8,8 @@
 #pragma config IOL1WAY = ON    // Peripheral Pin Select Configuration->Allow only one reconfiguration
 #pragma config FUSBIDIO = ON    // USB USID Selection->Controlled by the USB Module
 #pragma config FVBUSONIO = ON    // USB VBUS ON Selection->Controlled by USB Module
+// Los MX1xx/2xx no tienen FSRSSEL: su único juego de registros sombra es el
+// de las interrupciones de IPL7 (IPL7SRS).
 
 // DEVCFG2
 #pragma config FPLLIDIV = DIV_2    // PLL Input Divider->2x Divider
@@ -18,7 +20,7 @@
 
 // DEVCFG1
 #pragma config FNOSC = PRIPLL    // Oscillator Selection Bits->Primary Osc w/PLL (XT+,HS+,EC+PLL)
-#pragma config FSOSCEN = OFF    // Secondary Oscillator Enable->Disabled
+#pragma config FSOSCEN = ON    // Secondary Oscillator Enable->Enabled (RTCC)
 #pragma config IESO = ON    // Internal/External Switch Over->Enabled
 #pragma config POSCMOD = XT    // Primary Oscillator Configuration->XT osc mode
 #pragma config OSCIOFNC = OFF    // CLKO Output Signal Active on the OSCO Pin->Disabled
@@ -63,3 +65,9 @@ void InicializarReloj(void)
     // Una vez hemos terminado, lo volvemos a bloquear
     SYSKEY = 0x0;
 }
+
+// Frecuencia real del bus de periféricos, según el divisor que haya en OSCCON
+uint32_t getFrecuenciaPeriferico(void)
+{
+    return SYSCLK >> OSCCONbits.PBDIV;
+}
@@ -12,7 +12,14 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
+// Relojes fijados por los bits de configuración (ver Pic32Ini.c)
+#define SYSCLK 40000000
+#define PBCLK  (SYSCLK / 8)
+
 void InicializarReloj(void);
+uint32_t getFrecuenciaPeriferico(void);
 
 
 #ifdef	__cplusplus
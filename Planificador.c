@@ -0,0 +1,223 @@
+#include <xc.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "Planificador.h"
+#include "Timer.h"
+#include "Temporizadores.h"
+#include "Perfil.h"
+#include "Comandos.h"
+#include "Uart.h"
+#include "Formato.h"
+#include "SeccionCritica.h"
+
+#if (TAM_COLA_TAREA & (TAM_COLA_TAREA - 1)) != 0
+#error "TAM_COLA_TAREA ha de ser potencia de 2"
+#endif
+
+// Plazo que se pide a dormirHasta() cuando no hay temporizadores. Cada wait
+// dura en realidad como mucho MAX_MS_TICK (Timer.c), lo que da el Timer1.
+#define MS_REPOSO_MAXIMO 1000
+
+// La interrupción más prioritaria que publica eventos (UART1)
+#define IPL_EVENTOS IPL_UART
+
+static tarea_t *tareas[MAX_TAREAS];
+static int num_tareas = 0;
+
+// Carga desde la última lectura de getCargaPlanificador()
+static uint32_t despachos = 0;
+static uint32_t max_ciclos_despacho = 0;
+
+static void comandoTareas(int32_t arg);
+
+static const comando_t comandos_planificador[] = {
+    {"Tareas", ARG_NINGUNO, 0, 0, comandoTareas, "Ejecuciones, esperas y tiempos por tarea", NULL},
+};
+
+void InicializarPlanificador(void) {
+    registrarComandos(comandos_planificador, sizeof(comandos_planificador) / sizeof(comandos_planificador[0]));
+}
+
+// Devuelve 0, o -1 si no caben más tareas.
+int crearTarea(tarea_t *t, const char *nombre, uint8_t prioridad, uint32_t plazo_ms,
+               uint32_t suscripcion, void (*funcion)(const evento_tarea_t *evento)) {
+    estadisticas_tarea_t cero = {0};
+
+    if (num_tareas == MAX_TAREAS) {
+        return -1;
+    }
+    t->nombre = nombre;
+    t->prioridad = prioridad;
+    t->plazo_ms = plazo_ms;
+    t->suscripcion = suscripcion;
+    t->funcion = funcion;
+    t->primero = 0;
+    t->fin = 0;
+    t->estadisticas = cero;
+    tareas[num_tareas++] = t;
+    return 0;
+}
+
+// Entrega el evento a todas las tareas suscritas y devuelve a cuántas. Se
+// puede llamar desde las ISR de prioridad hasta IPL_EVENTOS: las escrituras en
+// las colas se protegen con ese techo, porque hay varios productores.
+int publicarEvento(tipo_evento_t tipo, int32_t dato) {
+    uint32_t ahora = getTiempoAbsoluto();
+    int entregados = 0;
+    int i;
+
+    for (i = 0; i < num_tareas; i++) {
+        tarea_t *t = tareas[i];
+        uint32_t estado;
+
+        if (!(t->suscripcion & EVENTO(tipo))) {
+            continue;
+        }
+        estado = entrarSeccionCritica(IPL_EVENTOS);
+        if ((uint8_t) (t->fin - t->primero) == TAM_COLA_TAREA) {
+            t->estadisticas.perdidos++;
+        } else {
+            evento_tarea_t *e = &t->cola[t->fin & (TAM_COLA_TAREA - 1)];
+
+            e->tipo = tipo;
+            e->dato = dato;
+            e->publicado = ahora;
+            t->fin++;
+            entregados++;
+            avisarTrabajo();
+        }
+        salirSeccionCritica(estado);
+    }
+    return entregados;
+}
+
+// La tarea lista más prioritaria; a igualdad, la que vence antes.
+static tarea_t *elegirTarea(void) {
+    tarea_t *elegida = NULL;
+    uint32_t vence_elegida = 0;
+    int i;
+
+    for (i = 0; i < num_tareas; i++) {
+        tarea_t *t = tareas[i];
+        uint32_t vence;
+
+        if (t->primero == t->fin) {
+            continue;
+        }
+        vence = t->cola[t->primero & (TAM_COLA_TAREA - 1)].publicado + t->plazo_ms;
+        if (elegida == NULL || t->prioridad > elegida->prioridad ||
+            (t->prioridad == elegida->prioridad && (int32_t) (vence - vence_elegida) < 0)) {
+            elegida = t;
+            vence_elegida = vence;
+        }
+    }
+    return elegida;
+}
+
+// Procesa un evento. Devuelve 0 si no había ninguno pendiente.
+int despacharTarea(void) {
+    tarea_t *t = elegirTarea();
+    estadisticas_tarea_t *e;
+    evento_tarea_t evento;
+    uint32_t espera, inicio, ciclos;
+
+    if (t == NULL) {
+        return 0;
+    }
+    // Solo el programa principal consume, así que basta copiar y avanzar
+    evento = t->cola[t->primero & (TAM_COLA_TAREA - 1)];
+    t->primero++;
+
+    e = &t->estadisticas;
+    espera = getTiempoAbsoluto() - evento.publicado;
+    if (espera > e->max_espera_ms) {
+        e->max_espera_ms = espera;
+    }
+    if (espera > t->plazo_ms) {
+        e->fuera_de_plazo++;
+    }
+
+    inicio = getCiclos();
+    t->funcion(&evento);
+    ciclos = getCiclos() - inicio;
+
+    e->ejecuciones++;
+    e->total_ciclos += ciclos;
+    if (ciclos > e->max_ciclos) {
+        e->max_ciclos = ciclos;
+    }
+    despachos++;
+    if (ciclos > max_ciclos_despacho) {
+        max_ciclos_despacho = ciclos;
+    }
+    return 1;
+}
+
+// Sustituye al bucle principal: no vuelve nunca. Las colas se miran por
+// última vez con el IPL en IPL_EVENTOS y dormirHasta() sale de esa sección
+// sin carreras: un evento publicado después de mirarlas despierta a la CPU
+// al momento en vez de esperar al siguiente vencimiento del Timer1.
+void ejecutarPlanificador(void) {
+    while (1) {
+        uint32_t ahora = getTiempoAbsoluto();
+        uint32_t estado;
+        int despachado;
+        PERFIL_INICIO(PERFIL_PLANIFICADOR);
+
+        procesarTemporizadores(ahora);
+        despachado = despacharTarea();
+
+        PERFIL_FIN(PERFIL_PLANIFICADOR);
+
+        if (despachado) {
+            continue;
+        }
+        estado = entrarSeccionCritica(IPL_EVENTOS);
+        if (elegirTarea() != NULL) {
+            salirSeccionCritica(estado); // Llegó un evento tras despachar
+        } else {
+            dormirHasta(ahora + msHastaProximo(MS_REPOSO_MAXIMO), estado);
+        }
+    }
+}
+
+// Eventos despachados y el más largo, en ciclos, desde la última llamada.
+void getCargaPlanificador(uint32_t *n, uint32_t *max_ciclos) {
+    *n = despachos;
+    *max_ciclos = max_ciclos_despacho;
+    despachos = 0;
+    max_ciclos_despacho = 0;
+}
+
+// Formato como el de "Ayuda": una línea por tarea con campos separados por ';'
+static void comandoTareas(int32_t arg) {
+    char mensaje[112];
+    char *p;
+    int i;
+
+    putsUART("#tarea;prioridad;plazo_ms;ejecuciones;perdidos;fuera_plazo;espera_max_ms;media_us;max_us\n\r");
+    for (i = 0; i < num_tareas; i++) {
+        const tarea_t *t = tareas[i];
+        estadisticas_tarea_t e = t->estadisticas;
+
+        p = fmtCadena(mensaje, t->nombre);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, t->prioridad);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, t->plazo_ms);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.ejecuciones);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.perdidos);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.fuera_de_plazo);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.max_espera_ms);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.ejecuciones ? (uint32_t) (e.total_ciclos / e.ejecuciones / CICLOS_POR_US) : 0);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.max_ciclos / CICLOS_POR_US);
+        p = fmtCadena(p, "\n\r");
+        writeUART(mensaje, p - mensaje);
+    }
+}
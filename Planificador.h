@@ -0,0 +1,67 @@
+#ifndef PLANIFICADOR_H
+#define PLANIFICADOR_H
+
+#include <stdint.h>
+
+// Planificador cooperativo dirigido por eventos. Las ISR y las funciones de
+// los temporizadores publican eventos; cada tarea recibe en su cola los tipos
+// a los que está suscrita y los procesa de uno en uno hasta el final, sin que
+// otra tarea se le adelante (las interrupciones sí). Entre varias tareas con
+// eventos pendientes se elige la de mayor prioridad y, a igual prioridad, la
+// de plazo más próximo. Sin eventos pendientes la CPU duerme hasta el
+// siguiente temporizador o interrupción.
+//
+// Como los temporizador_t, cada tarea_t la declara static su módulo. Las ISR
+// que publican han de tener prioridad IPL_UART o menor (ver Planificador.c).
+
+#define MAX_TAREAS 4
+#define TAM_COLA_TAREA 8 // Potencia de 2
+
+typedef enum {
+    EV_RX,          // Bytes nuevos en la cola de recepción de la UART
+    EV_CONFIG,      // Configuración nueva, validada y completa
+    EV_SENSOR,      // Cambio del sensor; dato: nivel del pin en la ISR
+    EV_DISPENSADO,  // Fin de una dispensación; dato: gramos
+    EV_TELEMETRIA,  // Toca enviar un registro de telemetría
+    EV_MINUTO,      // Cambio de minuto del reloj
+    EV_PANTALLA,    // Redibujar; dato: pantalla
+    NUM_TIPOS_EVENTO
+} tipo_evento_t;
+
+#define EVENTO(tipo) (1u << (tipo))
+
+typedef struct {
+    uint8_t tipo;
+    int32_t dato;
+    uint32_t publicado; // ms de getTiempoAbsoluto()
+} evento_tarea_t;
+
+typedef struct {
+    uint32_t ejecuciones;
+    uint32_t perdidos;        // Eventos que no cabían en la cola
+    uint32_t fuera_de_plazo;  // Empezados después de publicado + plazo_ms
+    uint32_t max_espera_ms;
+    uint32_t max_ciclos;      // Ciclos de Count (50 ns) por evento
+    uint64_t total_ciclos;
+} estadisticas_tarea_t;
+
+typedef struct {
+    const char *nombre;
+    uint8_t prioridad;        // Mayor número, más prioritaria
+    uint32_t plazo_ms;        // Espera máxima entre publicar y empezar
+    uint32_t suscripcion;     // EVENTO(tipo) | ...
+    void (*funcion)(const evento_tarea_t *evento);
+    evento_tarea_t cola[TAM_COLA_TAREA];
+    volatile uint8_t primero, fin;
+    estadisticas_tarea_t estadisticas;
+} tarea_t;
+
+void InicializarPlanificador(void);
+int crearTarea(tarea_t *t, const char *nombre, uint8_t prioridad, uint32_t plazo_ms,
+               uint32_t suscripcion, void (*funcion)(const evento_tarea_t *evento));
+int publicarEvento(tipo_evento_t tipo, int32_t dato);
+int despacharTarea(void);
+void ejecutarPlanificador(void);
+void getCargaPlanificador(uint32_t *despachos, uint32_t *max_ciclos);
+
+#endif
@@ -0,0 +1,378 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "Protocolo.h"
+#include "Comandos.h"
+#include "Uart.h"
+#include "Mascota.h"
+#include "Servo.h"
+#include "Timer.h"
+
+#define TAM_CRC 2
+// COBS añade un byte cada 254 y otro al principio
+#define MAX_TRAMA_COBS (MAX_MENSAJE_BIN + TAM_CRC + (MAX_MENSAJE_BIN + TAM_CRC) / 254 + 1)
+
+static uint8_t trama[MAX_TRAMA_COBS];
+static int long_trama = 0;
+static int en_trama = 0;
+static int solo_texto = 0;      // Ningún byte de control desde el 0x00
+static uint32_t ultimo_byte = 0; // ms del último byte de la trama
+static int long_devuelto = 0;   // Bytes de trama[] que eran texto
+static int eventos_activos = 0;
+
+static void procesarTrama(void);
+
+uint16_t calcularCrc16(const uint8_t *datos, uint32_t n) {
+    uint16_t crc = 0xFFFF;
+    uint32_t i;
+    int bit;
+
+    for (i = 0; i < n; i++) {
+        crc ^= (uint16_t) datos[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+uint32_t codificarCobs(const uint8_t *origen, uint32_t n, uint8_t *destino) {
+    uint32_t leido = 0, escrito = 1, pos_codigo = 0;
+    uint8_t codigo = 1;
+
+    while (leido < n) {
+        if (origen[leido] == 0) {
+            destino[pos_codigo] = codigo;
+            pos_codigo = escrito++;
+            codigo = 1;
+        } else {
+            destino[escrito++] = origen[leido];
+            if (++codigo == 0xFF) {
+                destino[pos_codigo] = codigo;
+                pos_codigo = escrito++;
+                codigo = 1;
+            }
+        }
+        leido++;
+    }
+    destino[pos_codigo] = codigo;
+    return escrito;
+}
+
+// Devuelve la longitud decodificada, o -1 si la trama está mal formada.
+int decodificarCobs(const uint8_t *origen, uint32_t n, uint8_t *destino) {
+    uint32_t leido = 0, escrito = 0;
+
+    while (leido < n) {
+        uint8_t codigo = origen[leido++];
+        uint8_t i;
+
+        if (codigo == 0 || leido + codigo - 1 > n) {
+            return -1;
+        }
+        for (i = 1; i < codigo; i++) {
+            destino[escrito++] = origen[leido++];
+        }
+        if (codigo != 0xFF && leido < n) {
+            destino[escrito++] = 0;
+        }
+    }
+    return escrito;
+}
+
+uint8_t *poner16(uint8_t *p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    return p + 2;
+}
+
+uint8_t *poner32(uint8_t *p, uint32_t v) {
+    p = poner16(p, v);
+    return poner16(p, v >> 16);
+}
+
+static uint16_t leer16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+// mensaje ya contiene tipo, secuencia y datos; se le añade el CRC, se
+// codifica y se encola de una sola vez para que no se mezcle con texto. Las
+// tramas van por el carril de alarmas: la charla no puede dejarlas sin sitio.
+static void enviarMensaje(uint8_t *mensaje, uint32_t n) {
+    uint8_t salida[MAX_TRAMA_COBS + 2];
+    uint32_t longitud;
+
+    poner16(&mensaje[n], calcularCrc16(mensaje, n));
+    salida[0] = 0;
+    longitud = codificarCobs(mensaje, n + TAM_CRC, &salida[1]);
+    salida[longitud + 1] = 0;
+    writeUARTPrioridad(salida, longitud + 2, PRIO_ALARMA);
+}
+
+static void responder(uint8_t tipo, uint8_t secuencia, uint8_t estado) {
+    uint8_t mensaje[3 + TAM_CRC];
+
+    mensaje[0] = tipo | MSG_RESPUESTA;
+    mensaje[1] = secuencia;
+    mensaje[2] = estado;
+    enviarMensaje(mensaje, 3);
+}
+
+static uint8_t ejecutarPorNombre(const char *nombre, int longitud, int32_t arg) {
+    const comando_t *cmd = buscarComando(nombre, longitud);
+
+    if (cmd == NULL) {
+        return CMD_DESCONOCIDO;
+    }
+    return ejecutarComando(cmd, arg);
+}
+
+static uint16_t horaCodificada(int h, int m) {
+    return (h >= 0 && m >= 0) ? h * 100 + m : 0xFFFF;
+}
+
+#define SIN_CAMBIOS 0xFFFE
+
+// Aplica un hhmm codificado a la copia de la configuración.
+static uint8_t decodificarHora(uint16_t hhmm, int *h, int *m) {
+    if (hhmm == SIN_CAMBIOS) {
+        return CMD_OK;
+    }
+    if (hhmm == 0xFFFF) {
+        *h = -1;
+        *m = -1;
+        return CMD_OK;
+    }
+    if (!esHoraValida(hhmm)) {
+        return CMD_RANGO;
+    }
+    *h = hhmm / 100;
+    *m = hhmm % 100;
+    return CMD_OK;
+}
+
+static void procesarMensaje(const uint8_t *mensaje, int n) {
+    uint8_t tipo = mensaje[0];
+    uint8_t secuencia = mensaje[1];
+    const uint8_t *datos = &mensaje[2];
+    int long_datos = n - 2;
+    uint8_t respuesta[MAX_MENSAJE_BIN + TAM_CRC];
+    uint8_t *p = &respuesta[3];
+    uint8_t estado = CMD_OK;
+    estadisticas_tx_t tx;
+    estadisticas_rx_t rx;
+    config_t config;
+
+    switch (tipo) {
+        case MSG_PESO:
+            if (long_datos != 2) {
+                estado = CMD_FORMATO;
+            } else {
+                estado = ejecutarPorNombre("Peso", 4, leer16(datos));
+            }
+            break;
+
+        case MSG_HORARIO:
+            if (long_datos < 1 || datos[0] > 2 || long_datos != 1 + 2 * datos[0]) {
+                estado = CMD_FORMATO;
+                break;
+            }
+            getConfiguracion(&config);
+            if (datos[0] >= 1) {
+                estado = decodificarHora(leer16(&datos[1]), &config.hora1, &config.min1);
+            }
+            if (datos[0] >= 2 && estado == CMD_OK) {
+                estado = decodificarHora(leer16(&datos[3]), &config.hora2, &config.min2);
+            }
+            if (estado == CMD_OK) {
+                estado = setConfiguracion(&config);
+            }
+            break;
+
+        case MSG_CONFIG:
+            if (long_datos != 6 && long_datos != 8) {
+                estado = CMD_FORMATO;
+                break;
+            }
+            getConfiguracion(&config);
+            if (leer16(datos) != SIN_CAMBIOS) {
+                config.peso = leer16(datos);
+            }
+            estado = decodificarHora(leer16(&datos[2]), &config.hora1, &config.min1);
+            if (estado == CMD_OK) {
+                estado = decodificarHora(leer16(&datos[4]), &config.hora2, &config.min2);
+            }
+            if (long_datos == 8) {
+                config.dias1 = datos[6];
+                config.dias2 = datos[7];
+            }
+            if (estado == CMD_OK) {
+                estado = setConfiguracion(&config);
+            }
+            break;
+
+        case MSG_LEER_CONFIG:
+            p = poner16(p, getPeso());
+            p = poner16(p, getRacion() * 2);
+            p = poner16(p, horaCodificada(getHoraPrimera(), getMinPrimera()));
+            p = poner16(p, horaCodificada(getHoraSegunda(), getMinSegunda()));
+            getConfiguracion(&config);
+            *p++ = config.dias1;
+            *p++ = config.dias2;
+            break;
+
+        case MSG_LEER_ESTADISTICAS:
+            p = poner32(p, getTiempoAbsoluto());
+            p = poner32(p, getDispensaciones());
+            p = poner16(p, getOcupacionTxUART());
+            p = poner16(p, getOcupacionRxUART());
+            getEstadisticasTxUART(&tx);
+            p = poner32(p, tx.bytes_descartados);
+            p = poner32(p, tx.mensajes_descartados);
+            p = poner16(p, tx.max_ocupacion);
+            getEstadisticasRxUART(&rx);
+            p = poner32(p, rx.desbordamientos);
+            p = poner32(p, rx.errores_trama + rx.errores_paridad);
+            p = poner32(p, rx.bytes_perdidos);
+            break;
+
+        case MSG_DISPENSAR:
+            if (long_datos != 2) {
+                estado = CMD_FORMATO;
+            } else {
+                estado = ejecutarPorNombre("Dispensar", 9, leer16(datos));
+            }
+            break;
+
+        case MSG_EVENTOS:
+            if (long_datos != 1) {
+                estado = CMD_FORMATO;
+            } else {
+                eventos_activos = datos[0] != 0;
+            }
+            break;
+
+        case MSG_PERIODO_TELEMETRIA:
+            if (long_datos != 2) {
+                estado = CMD_FORMATO;
+            } else {
+                estado = ejecutarPorNombre("Telemetria", 10, leer16(datos));
+            }
+            break;
+
+        default:
+            estado = ESTADO_DESCONOCIDO;
+            break;
+    }
+
+    respuesta[0] = tipo | MSG_RESPUESTA;
+    respuesta[1] = secuencia;
+    respuesta[2] = estado;
+    enviarMensaje(respuesta, estado == CMD_OK ? p - respuesta : 3);
+}
+
+static void procesarTrama(void) {
+    uint8_t mensaje[MAX_TRAMA_COBS];
+    int n = decodificarCobs(trama, long_trama, mensaje);
+
+    if (n < 2 + TAM_CRC) {
+        return; // Sin tipo ni secuencia no hay a quién responder
+    }
+    n -= TAM_CRC;
+    if (calcularCrc16(mensaje, n) != leer16(&mensaje[n])) {
+        responder(mensaje[0], mensaje[1], ESTADO_ERROR_CRC);
+        return;
+    }
+    procesarMensaje(mensaje, n);
+}
+
+// Deja los bytes de la trama a medias para protocoloTextoDevuelto().
+static void abortarTrama(void) {
+    long_devuelto = long_trama;
+    en_trama = 0;
+    long_trama = 0;
+}
+
+destino_byte_t protocoloRecibirByte(uint8_t c) {
+    uint32_t ahora = getTiempoAbsoluto();
+
+    if (en_trama && ahora - ultimo_byte > MS_ENTRE_BYTES) {
+        abortarTrama(); // Y el byte se trata como el primero tras la pausa
+    }
+    ultimo_byte = ahora;
+
+    if (c == 0) {
+        if (en_trama && long_trama > 0) {
+            procesarTrama();
+            en_trama = 0;
+        } else {
+            en_trama = 1;
+            long_trama = 0;
+            solo_texto = 1;
+        }
+        return BYTE_TRAMA;
+    }
+    if (!en_trama) {
+        return BYTE_TEXTO;
+    }
+    // En una trama de verdad el segundo byte es el tipo, siempre de control,
+    // así que un fin de línea tras solo texto no puede ser parte de ella.
+    if ((c == '\n' || c == '\r') && solo_texto && long_trama > 0) {
+        abortarTrama();
+        return BYTE_TEXTO;
+    }
+    if (long_trama == MAX_TRAMA_COBS) {
+        abortarTrama();
+        return BYTE_TEXTO;
+    }
+    if (long_trama > 0 && (c < ' ' || c > '~')) {
+        solo_texto = 0;
+    }
+    trama[long_trama++] = c;
+    return BYTE_TRAMA;
+}
+
+// Bytes de una trama abortada, que eran texto. El puntero vale hasta la
+// siguiente llamada a protocoloRecibirByte().
+int protocoloTextoDevuelto(const uint8_t **texto) {
+    int n = long_devuelto;
+
+    *texto = trama;
+    long_devuelto = 0;
+    return n;
+}
+
+// Mensaje espontáneo, sin petición previa.
+void protocoloEnviarMensaje(uint8_t tipo, uint8_t secuencia, const uint8_t *datos, uint32_t n) {
+    uint8_t mensaje[MAX_MENSAJE_BIN + TAM_CRC];
+    uint32_t i;
+
+    if (n > MAX_MENSAJE_BIN - 2) {
+        return;
+    }
+    mensaje[0] = tipo;
+    mensaje[1] = secuencia;
+    for (i = 0; i < n; i++) {
+        mensaje[2 + i] = datos[i];
+    }
+    enviarMensaje(mensaje, n + 2);
+}
+
+// Descarta la trama a medias, si la hay.
+void protocoloReiniciar(void) {
+    en_trama = 0;
+    long_trama = 0;
+    long_devuelto = 0;
+}
+
+void protocoloEnviarEvento(evento_t codigo, int32_t dato) {
+    uint8_t mensaje[2 + 5 + TAM_CRC];
+
+    if (!eventos_activos) {
+        return;
+    }
+    mensaje[0] = MSG_EVENTO;
+    mensaje[1] = 0;
+    mensaje[2] = codigo;
+    poner32(&mensaje[3], dato);
+    enviarMensaje(mensaje, 7);
+}
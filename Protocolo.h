@@ -0,0 +1,78 @@
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <stdint.h>
+
+// Protocolo binario sobre UART1, compatible con la consola de texto.
+// Cada trama va delimitada por ceros: 0x00 COBS(mensaje + CRC) 0x00.
+// Como las líneas de texto nunca contienen 0x00, ambos modos conviven.
+//
+// mensaje: tipo (1 byte), secuencia (1 byte) y datos. Los enteros van en
+// little endian. El CRC es CRC-16/CCITT-FALSE del mensaje, en little endian.
+// Cada petición recibe una respuesta con tipo | MSG_RESPUESTA, la misma
+// secuencia y un byte de estado (resultado_cmd_t) seguido de los datos.
+
+#define MAX_MENSAJE_BIN 64
+
+#define MSG_RESPUESTA        0x80
+
+#define MSG_PESO             0x01 // u16 kg
+#define MSG_HORARIO          0x02 // u8 n, n x u16 hhmm (0xFFFF = sin programar), todo o nada
+#define MSG_LEER_CONFIG      0x03 // -> u16 peso, u16 racion, 2 x u16 hhmm,
+                                  //    2 x u8 máscara de días
+#define MSG_LEER_ESTADISTICAS 0x04 // -> u32 ms, u32 dispensaciones, u16 tx, u16 rx,
+                                   //    u32 bytes y u32 mensajes descartados en TX,
+                                   //    u16 máxima ocupación de TX,
+                                   //    u32 desbordamientos, u32 errores de
+                                   //    trama/paridad y u32 perdidos en RX
+#define MSG_DISPENSAR        0x05 // u16 g
+#define MSG_EVENTOS          0x06 // u8 activar
+#define MSG_PERIODO_TELEMETRIA 0x07 // u16 ms (0 = desactivada)
+#define MSG_CONFIG           0x08 // u16 peso, 2 x u16 hhmm, todo o nada
+                                  // (0xFFFE = sin cambios, 0xFFFF = sin programar)
+                                  // y opcionalmente 2 x u8 máscara de días
+                                  // (bit 0 domingo .. bit 6 sábado)
+#define MSG_EVENTO           0x40 // Espontáneo: u8 codigo, i32 dato
+#define MSG_TELEMETRIA       0x41 // Espontáneo, secuencia incremental:
+                                  //   u32 ms, u16 peso, u16 racion, u16 hhmm
+                                  //   próxima comida, u8 comiendo, u8 estado,
+                                  //   u32 dispensaciones, u16 tx, u16 rx,
+                                  //   u16 eventos despachados y u16 evento
+                                  //   más largo en us desde el registro anterior
+
+#define ESTADO_ERROR_CRC     0xFE // Además de los resultado_cmd_t
+#define ESTADO_DESCONOCIDO   0xFF
+
+typedef enum {
+    EVT_COMIENDO = 1,
+    EVT_PARA_DE_COMER,
+    EVT_DISPENSADO,
+    EVT_CONFIG
+} evento_t;
+
+// Una trama a medias se aborta si se desborda, si pasan MS_ENTRE_BYTES sin
+// bytes o si llega un fin de línea cuando todo lo anterior era texto (un 0x00
+// espurio seguido de un comando). Sus bytes se devuelven entonces al
+// intérprete de líneas: tras cada protocoloRecibirByte() hay que vaciar
+// protocoloTextoDevuelto() y después, si es BYTE_TEXTO, tratar el propio byte.
+#define MS_ENTRE_BYTES 200
+
+typedef enum {
+    BYTE_TEXTO,  // Para el intérprete de líneas
+    BYTE_TRAMA   // Consumido por el protocolo
+} destino_byte_t;
+
+destino_byte_t protocoloRecibirByte(uint8_t c);
+int protocoloTextoDevuelto(const uint8_t **texto);
+void protocoloReiniciar(void);
+void protocoloEnviarEvento(evento_t codigo, int32_t dato);
+void protocoloEnviarMensaje(uint8_t tipo, uint8_t secuencia, const uint8_t *datos, uint32_t n);
+
+uint8_t *poner16(uint8_t *p, uint16_t v);
+uint8_t *poner32(uint8_t *p, uint32_t v);
+
+uint16_t calcularCrc16(const uint8_t *datos, uint32_t n);
+uint32_t codificarCobs(const uint8_t *origen, uint32_t n, uint8_t *destino);
+int decodificarCobs(const uint8_t *origen, uint32_t n, uint8_t *destino);
+
+#endif
@@ -0,0 +1,124 @@
+#include <xc.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "Pic32Ini.h"
+#include "Registro.h"
+#include "Cola.h"
+#include "Comandos.h"
+#include "Formato.h"
+#include "Timer.h"
+
+#ifndef TAM_COLA_REGISTRO
+#define TAM_COLA_REGISTRO 512
+#endif
+
+#if !ES_POTENCIA_DE_2(TAM_COLA_REGISTRO)
+#error "TAM_COLA_REGISTRO ha de ser potencia de 2"
+#endif
+
+#define MAX_TRAZA 80 // Cabecera más mensaje: los mensajes son literales cortos
+
+// cola_registro: productor registrar() (programa principal), consumidor la ISR
+// de TX de la UART2, que rellena la FIFO mientras tenga hueco.
+static cola_t cola_registro;
+static uint8_t datos_registro[TAM_COLA_REGISTRO];
+static nivel_registro_t nivel_maximo = REG_INFO;
+static uint32_t descartadas = 0;
+
+static void comandoNivelRegistro(int32_t nivel);
+
+static const comando_t comandos_registro[] = {
+    {"Nivel Registro", ARG_ENTERO, REG_ERROR, REG_DEPURACION, comandoNivelRegistro,
+     "Trazas en UART2: 0 error, 1 aviso, 2 info, 3 depuracion", NULL},
+};
+
+void InicializarRegistro(uint32_t baudios) {
+    inicializarCola(&cola_registro, datos_registro, TAM_COLA_REGISTRO);
+
+    SYSKEY = 0xAA996655;
+    SYSKEY = 0x556699AA;
+    RPB10R = 2; // U2TX a RPB10
+    SYSKEY = 0x1CA11CA1;
+
+    U2BRG = (getFrecuenciaPeriferico() + 2 * baudios) / (4 * baudios) - 1;
+    IFS1bits.U2TXIF = 0;
+    IEC1bits.U2TXIE = 0; // Se habilita cuando hay algo que enviar
+    IPC9bits.U2IP = 2;   // Por debajo de la UART1 y su DMA
+    IPC9bits.U2IS = 0;
+    U2STAbits.UTXISEL = 0; // Interrupción mientras quede hueco en la FIFO
+    U2STAbits.UTXEN = 1;
+    U2MODE = 0x8008;       // ON y BRGH
+
+    registrarComandos(comandos_registro, sizeof(comandos_registro) / sizeof(comandos_registro[0]));
+}
+
+static void encolarTraza(const char *traza, uint32_t len) {
+    if (colaLibre(&cola_registro) < len) {
+        descartadas++;
+        return;
+    }
+    colaEscribir(&cola_registro, traza, len);
+    IEC1SET = _IEC1_U2TXIE_MASK;
+}
+
+// "[ms X] ", con X la inicial del nivel
+static char *cabecera(char *p, nivel_registro_t nivel) {
+    static const char letras[] = "EAID";
+
+    p = fmtCadena(p, "[");
+    p = fmtSinSigno(p, getTiempoAbsoluto());
+    p = fmtCadena(p, " ");
+    *p++ = letras[nivel];
+    return fmtCadena(p, "] ");
+}
+
+void registrar(nivel_registro_t nivel, const char *mensaje) {
+    char traza[MAX_TRAZA];
+    char *p;
+
+    if (nivel > nivel_maximo) {
+        return;
+    }
+    p = cabecera(traza, nivel);
+    p = fmtCadena(p, mensaje);
+    p = fmtCadena(p, "\n\r");
+    encolarTraza(traza, p - traza);
+}
+
+void registrarValor(nivel_registro_t nivel, const char *mensaje, int32_t valor) {
+    char traza[MAX_TRAZA];
+    char *p;
+
+    if (nivel > nivel_maximo) {
+        return;
+    }
+    p = cabecera(traza, nivel);
+    p = fmtCadena(p, mensaje);
+    p = fmtEntero(p, valor);
+    p = fmtCadena(p, "\n\r");
+    encolarTraza(traza, p - traza);
+}
+
+void setNivelRegistro(nivel_registro_t nivel) {
+    nivel_maximo = nivel;
+}
+
+uint32_t getTrazasDescartadas(void) {
+    return descartadas;
+}
+
+static void comandoNivelRegistro(int32_t nivel) {
+    setNivelRegistro(nivel);
+}
+
+void __attribute__((vector(_UART_2_VECTOR), interrupt(IPL2SOFT), nomips16)) InterrupcionUART2(void) {
+    uint8_t c;
+
+    while (!U2STAbits.UTXBF && colaLeerByte(&cola_registro, &c)) {
+        U2TXREG = c;
+    }
+    if (colaOcupada(&cola_registro) == 0) {
+        IEC1CLR = _IEC1_U2TXIE_MASK;
+    }
+    IFS1CLR = _IFS1_U2TXIF_MASK;
+}
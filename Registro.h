@@ -0,0 +1,25 @@
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+#include <stdint.h>
+
+// Consola de depuración en UART2 (solo TX, por RPB10). Tiene su propia cola
+// e interrupción de prioridad menor que la UART1, de modo que el volumen de
+// trazas nunca retrasa ni recorta las respuestas de configuración. Si la cola
+// está llena la traza se descarta y se cuenta; nunca se espera.
+// Como writeUART(), solo se llama desde el programa principal.
+
+typedef enum {
+    REG_ERROR,
+    REG_AVISO,
+    REG_INFO,
+    REG_DEPURACION
+} nivel_registro_t;
+
+void InicializarRegistro(uint32_t baudios);
+void registrar(nivel_registro_t nivel, const char *mensaje);
+void registrarValor(nivel_registro_t nivel, const char *mensaje, int32_t valor);
+void setNivelRegistro(nivel_registro_t nivel);
+uint32_t getTrazasDescartadas(void);
+
+#endif
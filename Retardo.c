@@ -2,47 +2,27 @@
 #include <stdint.h>
 #include "Retardo.h"
 #include "Pic32Ini.h"
+#include "Timer.h"
 
-#define MAX_CONTADOR 65535
-#define FREQ_TIMER 5000000
+#define CICLOS_POR_US (SYSCLK / 2 / 1000000)
+#define MAX_MS_CONTADOS 10 // Hasta aquí se cuenta con Count, más fino que el tick
 
-int Retardo(uint16_t retardo_ms){
+void RetardoUs(uint32_t us) {
+    uint32_t inicio = _CP0_GET_COUNT();
+    uint32_t ciclos = us * CICLOS_POR_US;
 
-    if (retardo_ms == 0){ 
-        return 1;
-    }
-
-    uint8_t preesc;
-    uint32_t contador = 0; 
+    while (_CP0_GET_COUNT() - inicio < ciclos);
+}
 
-    for (preesc = 0; preesc <= 3; preesc++){ 
-        if (preesc!=3){
-            contador = (retardo_ms * (FREQ_TIMER/1000) / (1 << preesc)) - 1;
-        }else{
-            contador = (retardo_ms * (FREQ_TIMER/1000) / (256)) - 1;
-        }
-   
-        if (contador <= MAX_CONTADOR){
-            break;
+// Con el tick se espera un ms más: el primero puede estar ya casi acabado.
+void Retardo(uint32_t ms) {
+    if (ms <= MAX_MS_CONTADOS || !hayTickSistema()) {
+        while (ms-- > 0) {
+            RetardoUs(1000);
         }
-    }
+    } else {
+        uint32_t inicio = getTiempoAbsoluto();
 
-    if (contador > MAX_CONTADOR) {
-        return 1;
+        while (getTiempoAbsoluto() - inicio <= ms);
     }
-
-    T1CON = 0; 
-    TMR1 = 0; 
-    IFS0bits.T1IF = 0; 
-    PR1 = contador; 
-    T1CONbits.TCKPS = preesc;
-    T1CONbits.ON = 1;
-
-    while(IFS0bits.T1IF == 0); 
-    IFS0bits.T1IF = 0;
-    T1CON = 0; 
-    
-   
-    return 0;
-   }
-   
\ No newline at end of file
+}
@@ -3,6 +3,14 @@
 
 #include <stdint.h>
 
-int Retardo(uint16_t retardo_ms);
+// Servicio único de esperas. Ninguna toca el Timer1 ni otro temporizador:
+// las cortas cuentan ciclos del registro Count del CP0 (SYSCLK/2) y las de
+// varios ms se miden con el tiempo del sistema de Timer.c. Antes de
+// InicializarTimer() (arranque del TFT) todo se cuenta con Count.
 
-#endif
\ No newline at end of file
+void RetardoUs(uint32_t us);
+// Bloquea la tarea y, con ella, a todo el planificador: para esperas largas
+// dentro de una tarea, un temporizador que publique un evento.
+void Retardo(uint32_t ms);
+
+#endif
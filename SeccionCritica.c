@@ -0,0 +1,118 @@
+#include <xc.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "SeccionCritica.h"
+#include "Perfil.h"
+#include "Comandos.h"
+#include "Uart.h"
+#include "Formato.h"
+
+#define NUM_IPL 8
+
+typedef struct {
+    uint32_t veces;
+    uint32_t max;
+    uint64_t total;
+} estadistica_critica_t;
+
+// Cada entrada solo se escribe con el IPL en su techo: ninguna interrupción
+// que pudiera subirlo al mismo nivel puede ejecutarse a la vez.
+static estadistica_critica_t estadisticas[NUM_IPL];
+static uint32_t inicio[NUM_IPL];
+
+static void comandoSeccionesCriticas(int32_t arg);
+static void comandoBorrarSecciones(int32_t arg);
+
+static const comando_t comandos_critica[] = {
+    {"Secciones Criticas", ARG_NINGUNO, 0, 0, comandoSeccionesCriticas, "Veces y ciclos (50 ns) con el IPL subido, por techo", NULL},
+    {"Borrar Secciones Criticas", ARG_NINGUNO, 0, 0, comandoBorrarSecciones, "Pone a cero las medidas de secciones criticas", NULL},
+};
+
+void InicializarSeccionCritica(void) {
+    registrarComandos(comandos_critica, sizeof(comandos_critica) / sizeof(comandos_critica[0]));
+}
+
+static uint32_t iplDe(uint32_t status) {
+    return (status & _CP0_STATUS_IPL_MASK) >> _CP0_STATUS_IPL_POSITION;
+}
+
+// Devuelve el Status anterior, que hay que pasar a salirSeccionCritica(). Si
+// la CPU ya estaba en el techo o por encima, no cambia nada. Una interrupción
+// entre la lectura y la escritura de Status lo deja como estaba al volver.
+uint32_t entrarSeccionCritica(uint32_t techo) {
+    uint32_t status = _CP0_GET_STATUS();
+
+    if (techo > iplDe(status)) {
+        _CP0_SET_STATUS((status & ~_CP0_STATUS_IPL_MASK) | (techo << _CP0_STATUS_IPL_POSITION));
+        asm volatile("ehb"); // El nuevo IPL rige desde la siguiente instrucción
+#if CRITICA_MEDIR
+        inicio[techo] = getCiclos();
+#endif
+    }
+    return status;
+}
+
+// Solo restaura el campo IPL.
+void salirSeccionCritica(uint32_t estado) {
+    uint32_t status = _CP0_GET_STATUS();
+    uint32_t techo = iplDe(status);
+
+    if (techo > iplDe(estado)) {
+#if CRITICA_MEDIR
+        estadistica_critica_t *e = &estadisticas[techo];
+        uint32_t ciclos = getCiclos() - inicio[techo];
+
+        e->veces++;
+        e->total += ciclos;
+        if (ciclos > e->max) {
+            e->max = ciclos;
+        }
+#endif
+        _CP0_SET_STATUS((status & ~_CP0_STATUS_IPL_MASK) | (estado & _CP0_STATUS_IPL_MASK));
+    }
+}
+
+// Formato como el de "Perfil": una línea por techo usado
+static void comandoSeccionesCriticas(int32_t arg) {
+    char mensaje[64];
+    char *p;
+    int techo;
+
+    putsUART("#techo;veces;media;max;max_us\n\r");
+    for (techo = 1; techo < NUM_IPL; techo++) {
+        estadistica_critica_t e;
+        uint32_t estado = entrarSeccionCritica(techo);
+
+        e = estadisticas[techo];
+        salirSeccionCritica(estado);
+        if (e.veces == 0) {
+            continue;
+        }
+
+        p = fmtCadena(mensaje, "IPL");
+        p = fmtSinSigno(p, techo);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.veces);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, (uint32_t) (e.total / e.veces));
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.max);
+        p = fmtCadena(p, ";");
+        p = fmtSinSigno(p, e.max / CICLOS_POR_US);
+        p = fmtCadena(p, "\n\r");
+        writeUART(mensaje, p - mensaje);
+    }
+}
+
+static void comandoBorrarSecciones(int32_t arg) {
+    int techo;
+
+    for (techo = 1; techo < NUM_IPL; techo++) {
+        uint32_t estado = entrarSeccionCritica(techo);
+
+        estadisticas[techo].veces = 0;
+        estadisticas[techo].max = 0;
+        estadisticas[techo].total = 0;
+        salirSeccionCritica(estado);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef SECCIONCRITICA_H
+#define SECCIONCRITICA_H
+
+#include <stdint.h>
+
+// Secciones críticas por prioridad. En vez de deshabilitar todas las
+// interrupciones con di/ei, se sube el IPL de la CPU (campo IPL del registro
+// Status del CP0) hasta el techo: la prioridad más alta de las interrupciones
+// que comparten los datos. Las de prioridad mayor se siguen atendiendo.
+// Salir deja el IPL como estaba, así que se pueden anidar y usar en las ISR.
+//
+//     uint32_t estado = entrarSeccionCritica(IPL_UART);
+//     ...
+//     salirSeccionCritica(estado);
+//
+// Cada vez que se sube el IPL se mide con Count cuánto tiempo se mantiene; el
+// comando "Secciones Criticas" muestra el máximo por techo. Con
+// -DCRITICA_MEDIR=0 no se mide.
+
+#ifndef CRITICA_MEDIR
+#define CRITICA_MEDIR 1
+#endif
+
+// Prioridades que programa cada módulo en sus IPC, para usarlas como techo
+#define IPL_TIMER1   7
+#define IPL_RTCC     6
+#define IPL_UART     3 // UART1 y su DMA
+#define IPL_REGISTRO 2 // UART2
+#define IPL_SENSOR   2 // Cambio de estado
+
+void InicializarSeccionCritica(void);
+uint32_t entrarSeccionCritica(uint32_t techo);
+void salirSeccionCritica(uint32_t estado);
+
+#endif
@@ -0,0 +1,30 @@
+#include <xc.h>
+#include <stdint.h>
+#include "Sensor.h"
+#include "Planificador.h"
+
+void InicializarSensor(void) {
+    ANSELCCLR = 1 << PIN_SENSOR;
+    TRISCSET = 1 << PIN_SENSOR;
+
+    CNCONCbits.ON = 1;
+    CNENCSET = 1 << PIN_SENSOR;
+    (void) PORTC; // Fija el valor de referencia para detectar cambios
+    IPC8bits.CNIP = 2;
+    IPC8bits.CNIS = 0;
+    IFS1bits.CNCIF = 0;
+    IEC1bits.CNCIE = 1;
+}
+
+int leerSensor(void) {
+    return (PORTC >> PIN_SENSOR) & 1;
+}
+
+// Solo publica el cambio: el antirrebote lo hace una tarea con un
+// temporizador.
+void __attribute__((vector(_CHANGE_NOTICE_VECTOR), interrupt(IPL2SOFT), nomips16)) InterrupcionSensor(void) {
+    uint32_t puerto = PORTC; // Leer el puerto rearma la detección
+
+    IFS1bits.CNCIF = 0;
+    publicarEvento(EV_SENSOR, (puerto >> PIN_SENSOR) & 1);
+}
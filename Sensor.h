@@ -0,0 +1,13 @@
+#ifndef SENSOR_H
+#define SENSOR_H
+
+// Sensor de presencia en RC4. Cada cambio del pin genera una interrupción de
+// cambio de estado (CN), que publica un evento EV_SENSOR y despierta a la CPU
+// si está en reposo.
+
+#define PIN_SENSOR 4
+
+void InicializarSensor(void);
+int leerSensor(void);
+
+#endif
@@ -1,13 +1,26 @@
 #include <xc.h>
 #include <stdint.h>
+#include <stddef.h>
 
 #include "Servo.h"
+#include "Comandos.h"
+#include "Temporizadores.h"
+#include "Planificador.h"
 #include "Timer.h"
 
 #define PIN_SERVO 9
 #define FACTOR  6/150
 
 uint32_t t_alto = 1250;
+static uint32_t dispensaciones = 0;
+static temporizador_t temporizador_compuerta;
+static uint32_t gramos_en_curso = 0;
+
+static void comandoDispensar(int32_t gramos);
+
+static const comando_t comandos_servo[] = {
+    {"Dispensar", ARG_ENTERO, 1, 1000, comandoDispensar, "Dispensa los gramos indicados", NULL},
+};
 
 void InicializarServo(void){
     
@@ -28,6 +41,7 @@ void InicializarServo(void){
     PR2 = 49999;     // Periodo de 20 ms
     T2CON = 0x8010;  // T2 ON, Div = 2
     
+    registrarComandos(comandos_servo, sizeof(comandos_servo) / sizeof(comandos_servo[0]));
 }
 
 void apagarServo(){
@@ -59,14 +73,36 @@ uint32_t getTiempo(uint32_t cantidad){
     return 1000 * cantidad * FACTOR / 6; // FACTOR*6 g/s
 }
 
+static void cerrarCompuerta(void *dato){
+    sumaAngulo(-90);
+    dispensaciones++;
+    publicarEvento(EV_DISPENSADO, gramos_en_curso);
+    gramos_en_curso = 0;
+}
+
+// No bloquea: abre la compuerta y la cierra un temporizador, que publica
+// EV_DISPENSADO. Lo que se pida con la compuerta abierta alarga la misma
+// dispensación.
 void dispensar(uint32_t cantidad){
-    sumaAngulo(90);
+    uint32_t ms = getTiempo(cantidad);
 
-    uint32_t inicio;
-    uint32_t ms_espera = getTiempo(cantidad);
-    inicio = getTiempoAbsoluto();
+    if (temporizadorActivo(&temporizador_compuerta)) {
+        int32_t restante = temporizador_compuerta.vence - getTiempoAbsoluto();
 
-    while ((getTiempoAbsoluto() - inicio) < ms_espera);
+        if (restante > 0) {
+            ms += restante;
+        }
+    } else {
+        sumaAngulo(90);
+    }
+    gramos_en_curso += cantidad;
+    iniciarTemporizador(&temporizador_compuerta, ms, 0, cerrarCompuerta, NULL);
+}
 
-    sumaAngulo(-90);
+uint32_t getDispensaciones(void){
+    return dispensaciones;
+}
+
+static void comandoDispensar(int32_t gramos){
+    dispensar(gramos);
 }
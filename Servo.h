@@ -7,6 +7,7 @@ void InicializarServo(void);
 void sumaAngulo(uint32_t grados);
 uint32_t getGrados(void);
 void dispensar(uint32_t cantidad);
+uint32_t getDispensaciones(void);
 void apagarServo();
 void encenderServo();
 
@@ -0,0 +1,77 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "Telemetria.h"
+#include "Protocolo.h"
+#include "Comandos.h"
+#include "Uart.h"
+#include "Servo.h"
+#include "Timer.h"
+#include "Temporizadores.h"
+#include "Planificador.h"
+#include "Perfil.h"
+
+#define TAM_REGISTRO 24
+
+static uint32_t periodo_ms = 0;
+static temporizador_t temporizador_telemetria;
+static uint8_t secuencia = 0;
+
+static void comandoTelemetria(int32_t arg);
+
+static const comando_t comandos_telemetria[] = {
+    {"Telemetria", ARG_ENTERO, 0, TELEMETRIA_MAX_MS, comandoTelemetria,
+     "Periodo de telemetria binaria en ms (0 la desactiva)", NULL},
+};
+
+void InicializarTelemetria(void) {
+    registrarComandos(comandos_telemetria, sizeof(comandos_telemetria) / sizeof(comandos_telemetria[0]));
+}
+
+// El registro lo envía la tarea que tiene el estado, al recibir el evento.
+static void marcarPendiente(void *dato) {
+    (void) dato;
+    publicarEvento(EV_TELEMETRIA, 0);
+}
+
+// Formato del registro en Protocolo.h (MSG_TELEMETRIA)
+void enviarTelemetria(const telemetria_t *t) {
+    uint8_t registro[TAM_REGISTRO];
+    uint8_t *p = registro;
+    uint32_t despachos, max_ciclos;
+
+    getCargaPlanificador(&despachos, &max_ciclos);
+    max_ciclos /= CICLOS_POR_US;
+    p = poner32(p, getTiempoAbsoluto());
+    p = poner16(p, t->peso);
+    p = poner16(p, t->racion);
+    p = poner16(p, t->proxima);
+    *p++ = t->comiendo;
+    *p++ = t->estado;
+    p = poner32(p, getDispensaciones());
+    p = poner16(p, getOcupacionTxUART());
+    p = poner16(p, getOcupacionRxUART());
+    p = poner16(p, despachos > 0xFFFF ? 0xFFFF : despachos);
+    p = poner16(p, max_ciclos > 0xFFFF ? 0xFFFF : max_ciclos);
+
+    protocoloEnviarMensaje(MSG_TELEMETRIA, secuencia++, registro, p - registro);
+}
+
+void setPeriodoTelemetria(uint32_t ms) {
+    if (ms != 0 && ms < TELEMETRIA_MIN_MS) {
+        ms = TELEMETRIA_MIN_MS;
+    }
+    periodo_ms = ms;
+    if (ms != 0) {
+        iniciarTemporizador(&temporizador_telemetria, ms, ms, marcarPendiente, NULL);
+    } else {
+        pararTemporizador(&temporizador_telemetria);
+    }
+}
+
+uint32_t getPeriodoTelemetria(void) {
+    return periodo_ms;
+}
+
+static void comandoTelemetria(int32_t arg) {
+    setPeriodoTelemetria(arg);
+}
@@ -0,0 +1,27 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <stdint.h>
+
+// Registro de estado de formato fijo que se emite periódicamente como trama
+// MSG_TELEMETRIA del protocolo binario. Cada periodo se publica EV_TELEMETRIA
+// y la tarea de main que lleva el estado lo rellena; el resto de campos los
+// pone este módulo al enviarlo.
+
+#define TELEMETRIA_MIN_MS 100   // Periodo mínimo; 0 desactiva el envío
+#define TELEMETRIA_MAX_MS 60000
+
+typedef struct {
+    uint16_t peso;          // kg
+    uint16_t racion;        // g diarios
+    uint16_t proxima;       // hhmm de la siguiente comida, 0xFFFF sin programar
+    uint8_t comiendo;       // Estado confirmado del sensor
+    uint8_t estado;         // EstadoSistema de main
+} telemetria_t;
+
+void InicializarTelemetria(void);
+void enviarTelemetria(const telemetria_t *t);
+void setPeriodoTelemetria(uint32_t ms);
+uint32_t getPeriodoTelemetria(void);
+
+#endif
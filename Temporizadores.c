@@ -0,0 +1,173 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "Temporizadores.h"
+#include "Timer.h"
+
+// Nivel 0: 256 ranuras de 1 ms. Nivel 1: 64 de 256 ms (16,4 s).
+// Nivel 2: 64 de 16,4 s (17,5 min). Lo que vence más tarde se guarda en la
+// última ranura del nivel 2 y se recoloca en cada pasada.
+#define BITS_0 8
+#define BITS_1 6
+#define BITS_2 6
+#define RANURAS_0 (1 << BITS_0)
+#define RANURAS_1 (1 << BITS_1)
+#define RANURAS_2 (1 << BITS_2)
+#define MASCARA_0 (RANURAS_0 - 1)
+#define MASCARA_1 (RANURAS_1 - 1)
+#define MASCARA_2 (RANURAS_2 - 1)
+#define LIMITE_0 ((uint32_t) 1 << BITS_0)
+#define LIMITE_1 ((uint32_t) 1 << (BITS_0 + BITS_1))
+#define LIMITE_2 ((uint32_t) 1 << (BITS_0 + BITS_1 + BITS_2))
+
+static temporizador_t *nivel_0[RANURAS_0];
+static temporizador_t *nivel_1[RANURAS_1];
+static temporizador_t *nivel_2[RANURAS_2];
+static uint32_t actual; // Último tick procesado
+
+void InicializarTemporizadores(void) {
+    actual = getTiempoAbsoluto();
+}
+
+static void enlazar(temporizador_t **lista, temporizador_t *t) {
+    t->sig = *lista;
+    if (t->sig != NULL) {
+        t->sig->ant = &t->sig;
+    }
+    t->ant = lista;
+    *lista = t;
+}
+
+static void desenlazar(temporizador_t *t) {
+    *t->ant = t->sig;
+    if (t->sig != NULL) {
+        t->sig->ant = t->ant;
+    }
+    t->ant = NULL;
+}
+
+static void insertar(temporizador_t *t) {
+    uint32_t delta = t->vence - actual;
+    uint32_t vence = t->vence;
+
+    if ((int32_t) delta < 0) {
+        // Ya vencido: al siguiente tick
+        vence = actual + 1;
+        delta = 1;
+    }
+    if (delta < LIMITE_0) {
+        enlazar(&nivel_0[vence & MASCARA_0], t);
+    } else if (delta < LIMITE_1) {
+        enlazar(&nivel_1[(vence >> BITS_0) & MASCARA_1], t);
+    } else {
+        if (delta >= LIMITE_2) {
+            vence = actual + LIMITE_2 - 1;
+        }
+        enlazar(&nivel_2[(vence >> (BITS_0 + BITS_1)) & MASCARA_2], t);
+    }
+}
+
+void iniciarTemporizador(temporizador_t *t, uint32_t ms, uint32_t periodo,
+                         void (*funcion)(void *dato), void *dato) {
+    if (t->ant != NULL) {
+        desenlazar(t);
+    }
+    // Con 0 ms la ranura del tick actual puede estar ya procesada
+    t->vence = getTiempoAbsoluto() + (ms ? ms : 1);
+    t->periodo = periodo;
+    t->funcion = funcion;
+    t->dato = dato;
+    insertar(t);
+}
+
+void pararTemporizador(temporizador_t *t) {
+    if (t->ant != NULL) {
+        desenlazar(t);
+    }
+}
+
+int temporizadorActivo(const temporizador_t *t) {
+    return t->ant != NULL;
+}
+
+// Saca todos los temporizadores de una ranura y los vuelve a colocar según
+// el tiempo que les queda.
+static void cascada(temporizador_t **ranura) {
+    temporizador_t *t;
+
+    while ((t = *ranura) != NULL) {
+        desenlazar(t);
+        insertar(t);
+    }
+}
+
+static void vencer(temporizador_t **ranura) {
+    temporizador_t *lista = *ranura;
+    temporizador_t *t;
+
+    // Se trabaja sobre una lista aparte: las funciones pueden parar o
+    // reprogramar cualquier temporizador, incluidos los de esta ranura.
+    *ranura = NULL;
+    if (lista != NULL) {
+        lista->ant = &lista;
+    }
+    while ((t = lista) != NULL) {
+        desenlazar(t);
+        if ((int32_t) (t->vence - actual) > 0) {
+            insertar(t);
+            continue;
+        }
+        if (t->periodo != 0) {
+            t->vence += t->periodo;
+            insertar(t);
+        }
+        t->funcion(t->dato);
+    }
+}
+
+void procesarTemporizadores(uint32_t ahora) {
+    while (actual != ahora) {
+        actual++;
+        if ((actual & MASCARA_0) == 0) {
+            if (((actual >> BITS_0) & MASCARA_1) == 0) {
+                cascada(&nivel_2[(actual >> (BITS_0 + BITS_1)) & MASCARA_2]);
+            }
+            cascada(&nivel_1[(actual >> BITS_0) & MASCARA_1]);
+        }
+        vencer(&nivel_0[actual & MASCARA_0]);
+    }
+}
+
+static uint32_t minimoEnLista(const temporizador_t *t, uint32_t minimo) {
+    for (; t != NULL; t = t->sig) {
+        uint32_t delta = t->vence - actual;
+
+        if ((int32_t) delta <= 0) {
+            return 1;
+        }
+        if (delta < minimo) {
+            minimo = delta;
+        }
+    }
+    return minimo;
+}
+
+// Milisegundos desde el último tick procesado hasta el próximo vencimiento,
+// o 'horizonte' si no hay ninguno antes. Despertar antes de tiempo no hace
+// daño; después sí, así que de los niveles superiores se miran las ranuras
+// que se cascadean dentro del horizonte.
+uint32_t msHastaProximo(uint32_t horizonte) {
+    uint32_t minimo = horizonte < LIMITE_0 ? horizonte : LIMITE_0 - 1;
+    uint32_t d;
+
+    for (d = 1; d < minimo; d++) {
+        if (nivel_0[(actual + d) & MASCARA_0] != NULL) {
+            minimo = d;
+            break;
+        }
+    }
+    minimo = minimoEnLista(nivel_1[((actual + 1) >> BITS_0) & MASCARA_1], minimo);
+    minimo = minimoEnLista(nivel_1[((actual + minimo) >> BITS_0) & MASCARA_1], minimo);
+    minimo = minimoEnLista(nivel_2[((actual + 1) >> (BITS_0 + BITS_1)) & MASCARA_2], minimo);
+    minimo = minimoEnLista(nivel_2[((actual + minimo) >> (BITS_0 + BITS_1)) & MASCARA_2], minimo);
+    return minimo;
+}
@@ -0,0 +1,33 @@
+#ifndef TEMPORIZADORES_H
+#define TEMPORIZADORES_H
+
+#include <stdint.h>
+
+// Temporizadores software sobre el tick de 1 ms del Timer1, organizados en
+// una rueda jerárquica de tres niveles. Alta y baja son O(1) y no hay memoria
+// dinámica: cada módulo declara sus temporizador_t static (a cero) y la rueda
+// los enlaza por dentro.
+//
+// La rueda la hace avanzar procesarTemporizadores() desde el programa
+// principal, de modo que las funciones de los temporizadores vencidos se
+// ejecutan ahí y no en la interrupción. Si el bucle se ha retrasado, la rueda
+// recupera los ticks perdidos y ningún vencimiento se salta.
+
+typedef struct temporizador {
+    struct temporizador *sig;
+    struct temporizador **ant; // Enlace que apunta a este nodo
+    uint32_t vence;            // En ms de getTiempoAbsoluto()
+    uint32_t periodo;          // 0: de un solo disparo
+    void (*funcion)(void *dato);
+    void *dato;
+} temporizador_t;
+
+void InicializarTemporizadores(void);
+void iniciarTemporizador(temporizador_t *t, uint32_t ms, uint32_t periodo,
+                         void (*funcion)(void *dato), void *dato);
+void pararTemporizador(temporizador_t *t);
+int temporizadorActivo(const temporizador_t *t);
+void procesarTemporizadores(uint32_t ahora);
+uint32_t msHastaProximo(uint32_t horizonte);
+
+#endif
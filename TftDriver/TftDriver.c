@@ -23,6 +23,8 @@
 
 #include "TftDriver.h"
 #include "spi.h"
+#include "../Perfil.h"
+#include "../Retardo.h"
 
 // Documentación interna (Sólo para desarrolladores del driver)
 /// @cond INTERNAL
@@ -44,7 +46,6 @@
 
 /// @cond INTERNAL
 // Funciones privadas
-void Retardo(unsigned int ms);
 void setXY(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
 void clrXY(void);
 void drawHLine(int x, int y, int l);
@@ -210,12 +211,14 @@ void inicializarTFT(int orientacion)
 void clrScr(void)
 {
 	long i;
+	PERFIL_INICIO(PERFIL_CLR_SCR);
 	
 	clrXY();
 	for (i=0; i<((DISP_X_SIZE+1)*(DISP_Y_SIZE+1)); i++){
 		LCD_Write_DATA(0);
 		LCD_Write_DATA(0);
 	}
+	PERFIL_FIN(PERFIL_CLR_SCR);
 }
 
 /**
@@ -698,6 +701,7 @@ void drawBitmap(int x, int y, int sx, int sy, uint16_t data[], int scale)
 {
 	unsigned int col;
 	int tx, ty, tc, tsx, tsy;
+	PERFIL_INICIO(PERFIL_DRAW_BITMAP);
 
 	if (scale==1)
 	{
@@ -750,45 +754,13 @@ void drawBitmap(int x, int y, int sx, int sy, uint16_t data[], int scale)
 		}
 	}
 	clrXY();
+	PERFIL_FIN(PERFIL_DRAW_BITMAP);
 }
 
 /***************************************************************************/
 /************************** Funciones privadas *****************************/
 /***************************************************************************/
 /// @cond INTERNAL
-/**
- * Genera un retardo de n milisegundos usando el timer 1 en modo polling. La 
- * función guarda el estado del timer 1 para perturbar lo menos posible.
- *
- * @param n_ms Número de milisegundos a esperar
- *
- */
-
-void Retardo(unsigned int n_ms)
-{
-	int pr1_bak, t1con_bak;
-
-	// Guardo el estado del timer 1.
-	pr1_bak = PR1;
-	t1con_bak = T1CON;
-
-	// Inicializo el timer
-  TMR1 = 0;
-  PR1 = 5000; // Timer a 1 milisegundo. Como PBCLK son 5 MHz, hay que
-              //contar 5000
-  IFS0bits.T1IF = 0; // Borra el flag
-  T1CON = 0x8000; // Timer on, Prescaler = 0 while(IFS0bits.T1IF == 0)
-  while(n_ms != 0){
-    while(IFS0bits.T1IF == 0)
-      ; // Espera fin del timer
-    IFS0bits.T1IF = 0; // Borra el flag
-    n_ms--;
-  }
-	// Dejamos el timer 1 como estaba
-	T1CON = t1con_bak;
-	PR1 = pr1_bak;
-}
-
 /**
  * Selecciona el marco de la memoria gráfica del display en la que se van a
  * escribir datos. Para ello envía el comando 0x2A (Column Address Set) que
@@ -915,6 +887,7 @@ void printChar(uint8_t c, int x, int y)
 	uint16_t j;
 	uint16_t temp; 
 	int zz;
+	PERFIL_INICIO(PERFIL_PRINT_CHAR);
 	
 	if (!_transparent){
 		if (_orientacion==PORTRAIT){
@@ -967,6 +940,7 @@ void printChar(uint8_t c, int x, int y)
 	}
 
 	clrXY();
+	PERFIL_FIN(PERFIL_PRINT_CHAR);
 }
 
 /**
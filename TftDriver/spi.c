@@ -22,6 +22,7 @@
 #include <stdint.h>
 #include "spi.h"
 #include "../Pic32Ini.h"
+#include "../Perfil.h"
 
 #define PIN_SCK 15 // Puerto B (RB15), que está conectado al pin 10 del arduino
 #define PIN_SDO  8 // Puerto A (RA8), que está conectado al pin 11 del arduino
@@ -122,6 +123,7 @@ void InicializarSPI2(int frec)
  */
 void SPI_SendFrame(uint8_t dato)
 {   
+  PERFIL_INICIO(PERFIL_SPI);
   LATCCLR = 1 << PIN_SS;     // Activa SS
     
   while(SPI2STATbits.SPITBF)
@@ -135,6 +137,7 @@ void SPI_SendFrame(uint8_t dato)
     
 	dato = SPI2BUF; // Leo el dato, aunque no lo quiero para nada. Si no tengo error de overflow y no se para en el while anterior
   LATCSET =  1 << PIN_SS;     // Desactiva SS para finalizar la trama.
+  PERFIL_FIN(PERFIL_SPI);
 }
 
 // -----------------------------------------------------------------------------
@@ -1,81 +1,365 @@
 #include <xc.h>
+#include <stddef.h>
+#include "Pic32Ini.h"
+#include "Timer.h"
+#include "Uart.h"
+#include "Comandos.h"
+#include "Formato.h"
+#include "Cola.h"
+#include "Perfil.h"
+#include "SeccionCritica.h"
 
-static int ms = 0;
-static int s = 0;
-static int min = 0;
-static int h = 0;
+static volatile int ms = 0;
+static volatile int s = 0;
+static volatile int min = 0;
+static volatile int h = 0;
+
+// Contador de secuencia del reloj: impar mientras se está actualizando. Quien
+// lee repite si ha cambiado durante la lectura (ver getInstante()).
+static volatile uint32_t secuencia = 0;
+
+// Tiempo desde el arranque. No depende de la hora del reloj, así que las
+// diferencias entre dos lecturas son válidas aunque se cambie la hora o se
+// pase de un minuto a otro. milis_alto cuenta las vueltas de milis_bajo
+// (cada 49,7 días).
+static volatile uint32_t milis_bajo = 0;
+static volatile uint32_t milis_alto = 0;
+
+// Timer1 con prescaler 1:8: 625 cuentas por ms y periodos de hasta 104 ms.
+// Despierto el periodo es de 1 ms; para dormir se alarga hasta el siguiente
+// vencimiento y ms_tick guarda cuántos ms dura el periodo en curso.
+#define CUENTAS_MS (PBCLK / 8 / 1000)
+#define MAX_MS_TICK (65536 / CUENTAS_MS)
+
+static volatile uint32_t ms_tick = 1;
+static int tick_en_marcha = 0;
+static uint32_t ms_dormido = 0;
+
+// Latencia de la ISR del Timer1. La de entrada es lo que lleva contado TMR1
+// desde el vencimiento; cada cuenta son 8 ciclos de PBCLK. La de salida se
+// mide cuando la ISR es la que despierta a dormirHasta(): desde su última
+// instrucción hasta la vuelta a dormirHasta() tras rehabilitarlas.
+#define CICLOS_POR_CUENTA_T1 (CICLOS_POR_US * 8 * 1000000 / PBCLK)
+
+static volatile uint32_t fin_isr_timer1;
+static volatile int isr_timer1_terminada = 0;
+
+// Latencia de despertar: desde que una ISR deja trabajo (avisarTrabajo())
+// mientras se duerme hasta que dormirHasta() vuelve al programa principal.
+static volatile uint32_t ciclos_trabajo;
+static volatile int trabajo_avisado = 0;
+
+// Alarma de un solo disparo que se atiende en la propia ISR del Timer1, para
+// lo que no puede esperar a que el planificador procese los temporizadores
+// (las notas del zumbador). dormirHasta() no duerme más allá de ella.
+static void (*volatile funcion_alarma)(void) = NULL;
+static volatile uint32_t instante_alarma;
+
+static void comandoHora(int32_t arg);
+
+static const comando_t comandos_timer[] = {
+    {"Hora", ARG_NINGUNO, 0, 0, comandoHora, "Muestra la hora actual", NULL},
+};
 
 void InicializarTimer(void){
     T1CON = 0;
     TMR1 = 0;
-    PR1 = 4999; 
+    PR1 = CUENTAS_MS - 1;
     IPC1bits.T1IP = 7;  
     IPC1bits.T1IS = 0; 
     IFS0bits.T1IF = 0; 
     IEC0bits.T1IE = 1; 
-    T1CON = 0x8000;
+    T1CON = 0x8010; // ON, prescaler 1:8
+    tick_en_marcha = 1;
 
     INTCONbits.MVEC = 1; 
     asm("ei"); 
+
+    registrarComandos(comandos_timer, sizeof(comandos_timer) / sizeof(comandos_timer[0]));
 }
 
-void __attribute__((vector(4), interrupt(IPL7SOFT), nomips16)) InterrupcionTimer1(void){
-    IFS0bits.T1IF = 0;    
+// Avanza el reloj n ms. Se llama desde la interrupción del Timer1 o con
+// ella deshabilitada.
+static void avanzarReloj(uint32_t n) {
+    uint32_t anterior = milis_bajo;
+
+    secuencia++;
+    BARRERA_MEMORIA();
+
+    milis_bajo = anterior + n;
+    if (milis_bajo < anterior) {
+        milis_alto++;
+    }
 
-    ms++;
-    if (ms == 1000){
-        ms = 0;
+    ms += n;
+    while (ms >= 1000){
+        ms -= 1000;
         s++;
+        if (s == 60){
+            s = 0;
+            min++;
+        }
+        if (min == 60){
+            min = 0;
+            h++;
+        }
+        if (h == 24){
+            h = 0;
+        }
     }
-    if (s == 60){
-        s = 0;
-        min++;
+
+    BARRERA_MEMORIA();
+    secuencia++;
+}
+
+// Suma al reloj lo transcurrido del periodo en curso y deja el tick en 1 ms.
+// Se llama desde la interrupción del Timer1 o con ella deshabilitada.
+// Si el periodo ha vencido, sus ms_tick ms se suman tal cual: TMR1 acaba de
+// pasar a 0, lejos del nuevo PR1. Si no (ha despertado a la CPU otra
+// interrupción), se cuentan los ms enteros que lleva y se sigue desde el
+// resto; reescribir TMR1 pierde como mucho una cuenta (1,6 us).
+static void ponerAlDia(void) {
+    if (IFS0bits.T1IF) {
+        uint32_t n = ms_tick;
+
+        IFS0bits.T1IF = 0;
+        if (n != 1) {
+            ms_tick = 1;
+            PR1 = CUENTAS_MS - 1;
+        }
+        avanzarReloj(n);
+    } else if (ms_tick != 1) {
+        uint32_t transcurridos = TMR1 / CUENTAS_MS;
+
+        TMR1 -= transcurridos * CUENTAS_MS;
+        PR1 = CUENTAS_MS - 1;
+        ms_tick = 1;
+        avanzarReloj(transcurridos);
     }
-    if (min == 60){
-        min = 0;
-        h++;
+    if (funcion_alarma != NULL && (int32_t) (milis_bajo - instante_alarma) >= 0) {
+        void (*funcion)(void) = funcion_alarma;
+
+        funcion_alarma = NULL;
+        funcion(); // Puede volver a programarla
     }
-    if (h == 24){
-        h = 0;
+}
+
+// Con IPL7SRS la CPU cambia al juego de registros sombra en vez de guardar
+// y restaurar los de uso general en la pila.
+void __attribute__((vector(4), interrupt(IPL7SRS), nomips16)) InterrupcionTimer1(void){
+    PERFIL_MUESTRA(PERFIL_ENTRADA_TIMER1, TMR1 * CICLOS_POR_CUENTA_T1);
+    PERFIL_INICIO(PERFIL_ISR_TIMER1);
+    ponerAlDia();
+    PERFIL_FIN(PERFIL_ISR_TIMER1);
+    isr_timer1_terminada = 1;
+    fin_isr_timer1 = getCiclos();
+}
+
+static void volverATick(void) {
+    IEC0CLR = _IEC0_T1IE_MASK;
+    ponerAlDia();
+    IEC0SET = _IEC0_T1IE_MASK;
+}
+
+// La función se ejecuta en la ISR del Timer1 (o con ella enmascarada) en el
+// primer tick en que getTiempoAbsoluto() llega a instante. Sustituye a la
+// alarma anterior; se puede llamar también desde la propia función.
+void programarAlarma(uint32_t instante, void (*funcion)(void)) {
+    uint32_t estado = entrarSeccionCritica(IPL_TIMER1);
+
+    instante_alarma = instante;
+    funcion_alarma = funcion;
+    salirSeccionCritica(estado);
+}
+
+// Al volver, la función de la alarma ya no se ejecutará.
+void cancelarAlarma(void) {
+    funcion_alarma = NULL;
+}
+
+// La llaman las ISR que dejan trabajo para el programa principal, con su
+// escritura protegida por el techo de todas ellas (ver publicarEvento()).
+void avisarTrabajo(void) {
+    if (!trabajo_avisado) {
+        ciclos_trabajo = getCiclos();
+        trabajo_avisado = 1;
     }
 }
 
+// Deja la CPU en reposo (wait) hasta el instante dado, en ms de
+// getTiempoAbsoluto(), o hasta que la despierte cualquier interrupción. El
+// periodo del Timer1 se alarga hasta el vencimiento, como mucho MAX_MS_TICK,
+// y al despertar el reloj se pone al día con las cuentas transcurridas.
+//
+// Sin carreras con las ISR que dejan trabajo: quien llama sube el IPL a su
+// techo con entrarSeccionCritica(), comprueba que no hay nada pendiente y
+// pasa aquí el estado devuelto, sin salir. El wait se ejecuta con todas las
+// interrupciones deshabilitadas y el IPL ya devuelto a estado: en el PIC32
+// una interrupción que el IPL no deja pasar no despierta a la CPU, pero una
+// habilitada que solo está detenida por IE sí, sin saltar al vector. Así lo
+// que llega después de la comprobación despierta al momento y se atiende al
+// rehabilitarlas. Sale con el IPL de estado.
+void dormirHasta(uint32_t instante, uint32_t estado) {
+    uint32_t restantes;
+    uint32_t inicio;
+
+    asm volatile("di");
+    asm volatile("ehb");
+    salirSeccionCritica(estado);
+    if (funcion_alarma != NULL && (int32_t) (instante_alarma - instante) < 0) {
+        instante = instante_alarma;
+    }
+    inicio = milis_bajo;
+    restantes = instante - inicio;
+    if ((int32_t) restantes <= 1 || IFS0bits.T1IF) {
+        asm volatile("ei"); // Nada que ahorrar
+        return;
+    }
+    if (restantes > MAX_MS_TICK) {
+        restantes = MAX_MS_TICK;
+    }
+    ms_tick = restantes;
+    PR1 = restantes * CUENTAS_MS - 1; // TMR1 va por debajo de CUENTAS_MS
+    if (IFS0bits.T1IF) {
+        // El ms en curso venció mientras se reprogramaba: es solo 1 ms
+        PR1 = CUENTAS_MS - 1;
+        ms_tick = 1;
+        asm volatile("ei");
+        return;
+    }
+    isr_timer1_terminada = 0;
+    trabajo_avisado = 0;
+
+    asm volatile("wait");
+    asm volatile("ei");
+
+    // Si otra ISR se encadena tras la del Timer1, también cuenta: el mínimo
+    // es el que da el coste de la salida.
+    if (isr_timer1_terminada) {
+        PERFIL_MUESTRA(PERFIL_SALIDA_TIMER1, getCiclos() - fin_isr_timer1);
+    }
+    if (trabajo_avisado) {
+        PERFIL_MUESTRA(PERFIL_DESPERTAR, getCiclos() - ciclos_trabajo);
+    }
+
+    volverATick();
+    ms_dormido += milis_bajo - inicio;
+}
+
+// Hora y tiempo desde el arranque del mismo tick, sin deshabilitar
+// interrupciones: si el Timer1 avanza a mitad de la copia, se repite.
+void getInstante(instante_t *instante) {
+    uint32_t inicio;
+
+    do {
+        inicio = secuencia;
+        BARRERA_MEMORIA();
+        instante->h = h;
+        instante->m = min;
+        instante->s = s;
+        instante->ms = ms;
+        instante->milis = milis_bajo;
+        BARRERA_MEMORIA();
+    } while ((inicio & 1) || inicio != secuencia);
+}
+
 int getHoraActual(void){
-    int copia;
-    asm("di");
-    copia = h;
-    asm("ei");
-    return copia;
+    instante_t instante;
+
+    getInstante(&instante);
+    return instante.h;
 }
 
 int getMinutoActual(void){
-    int copia;
-    asm("di");
-    copia = min;
-    asm("ei");
-    return copia;
+    instante_t instante;
+
+    getInstante(&instante);
+    return instante.m;
 }
 
 int getSegundos(void) {
-    int copia;
-    asm("di");
-    copia = s;
-    asm("ei");
-    return copia;
+    instante_t instante;
+
+    getInstante(&instante);
+    return instante.s;
 }
 
 int getMilisegundos(void) {
-    int copia;
-    asm("di");
-    copia = ms;
-    asm("ei");
-    return copia;
+    instante_t instante;
+
+    getInstante(&instante);
+    return instante.ms;
+}
+
+// Retardo.c mide con getTiempoAbsoluto() solo si el tick ya corre.
+int hayTickSistema(void) {
+    return tick_en_marcha;
 }
 
+// Milisegundos desde el arranque. La lectura de 32 bits es atómica; las
+// restas entre dos lecturas son correctas también al dar la vuelta.
 uint32_t getTiempoAbsoluto(void) {
-    uint32_t copia;
-    asm("di");
-    copia = s * 1000 + ms;
-    asm("ei");
-    return copia;
+    return milis_bajo;
+}
+
+// Versión de 64 bits para estadísticas de larga duración. Si la interrupción
+// cambia la parte alta durante la lectura, se repite.
+uint64_t getTiempoAbsoluto64(void) {
+    uint32_t alto, bajo;
+
+    do {
+        alto = milis_alto;
+        bajo = milis_bajo;
+    } while (alto != milis_alto);
+    return ((uint64_t) alto << 32) | bajo;
+}
+
+// La hora la escriben también la ISR del RTCC (sincronizarHora()) y la del
+// Timer1, así que el techo es el del Timer1.
+void setHoraActual(int hora, int minuto, int segundo) {
+    uint32_t estado = entrarSeccionCritica(IPL_TIMER1);
+
+    secuencia++;
+    BARRERA_MEMORIA();
+    h = hora;
+    min = minuto;
+    s = segundo;
+    ms = 0;
+    TMR1 = 0;
+    BARRERA_MEMORIA();
+    secuencia++;
+    salirSeccionCritica(estado);
+}
+
+// Pone la hora en el flanco de un segundo de una referencia externa (el
+// RTCC). Se puede llamar desde interrupciones de cualquier prioridad.
+void sincronizarHora(int hora, int minuto, int segundo) {
+    uint32_t estado = entrarSeccionCritica(IPL_TIMER1);
+
+    ponerAlDia();
+    secuencia++;
+    BARRERA_MEMORIA();
+    h = hora;
+    min = minuto;
+    s = segundo;
+    ms = 0;
+    BARRERA_MEMORIA();
+    secuencia++;
+    salirSeccionCritica(estado);
+}
+
+static void comandoHora(int32_t arg) {
+    char mensaje[64];
+    char *p;
+    instante_t ahora;
+
+    getInstante(&ahora);
+    p = fmtCadena(mensaje, "Hora actual: ");
+    p = fmtHoraSeg(p, ahora.h, ahora.m, ahora.s);
+    p = fmtCadena(p, ", encendido ");
+    p = fmtSinSigno(p, getTiempoAbsoluto64() / 1000);
+    p = fmtCadena(p, " s, dormido ");
+    p = fmtSinSigno(p, ms_dormido / 1000);
+    p = fmtCadena(p, " s\n\r");
+    writeUART(mensaje, p - mensaje);
 }
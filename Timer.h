@@ -1,11 +1,28 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+#include <stdint.h>
+
+// Instantánea coherente del reloj: todos los campos son del mismo tick.
+typedef struct {
+    int h, m, s, ms;
+    uint32_t milis;   // Tiempo desde el arranque, como getTiempoAbsoluto()
+} instante_t;
+
 void InicializarTimer(void);
+void getInstante(instante_t *instante);
 int getHoraActual(void);
 int getMinutoActual(void);
 int getSegundos(void);
 int getMilisegundos(void);
 uint32_t getTiempoAbsoluto(void);
+int hayTickSistema(void);
+uint64_t getTiempoAbsoluto64(void);
+void setHoraActual(int hora, int minuto, int segundo);
+void sincronizarHora(int hora, int minuto, int segundo);
+void programarAlarma(uint32_t instante, void (*funcion)(void));
+void cancelarAlarma(void);
+void avisarTrabajo(void);
+void dormirHasta(uint32_t instante, uint32_t estado);
 
 #endif
@@ -1,37 +1,249 @@
 #include <xc.h>
-#include <stdlib.h>
 #include <string.h>
-#include <stdio.h>
 #include "Pic32Ini.h"
 #include "Uart.h"
+#include "Cola.h"
+#include "Comandos.h"
+#include "Protocolo.h"
+#include "Formato.h"
 #include "Mascota.h"
 #include "Timer.h"
+#include "Calendario.h"
+#include "Perfil.h"
+#include "Planificador.h"
+#include "Temporizadores.h"
+
+// Tamaños de las colas. Se pueden redefinir al compilar (-DTAM_COLA_TX=...),
+// pero han de ser potencia de 2.
+#ifndef TAM_COLA_TX
+#define TAM_COLA_TX 256
+#endif
+#ifndef TAM_COLA_RX
+#define TAM_COLA_RX 64
+#endif
+
+#if !ES_POTENCIA_DE_2(TAM_COLA_TX) || !ES_POTENCIA_DE_2(TAM_COLA_RX)
+#error "TAM_COLA_TX y TAM_COLA_RX han de ser potencia de 2"
+#endif
 
-#define TAM_COLA 200
 #define PIN_U1RX 13
 #define PIN_U1TX 7
+#define PIN_DE_RS485 2 // RB2: habilitación del driver del transceptor
 
-#define MAX_MENSAJE 30
+#define BIT_DIRECCION 0x100
+#define MAX_CAMBIOS_SELECCION 8 // Potencia de 2
 
-typedef struct {
-    int icabeza;
-    int icola;
-    char datos[TAM_COLA];
-} cola_t;
+#define MAX_ERROR_BAUDIOS 3 // % de error admisible en la velocidad
 
+// Los tramos de DMA se limitan para que el consumidor recupere el control con
+// frecuencia y pueda atender las peticiones de descarte de TX_DESCARTAR_ANTIGUO.
+#define MAX_TRAMO_DMA 64
+#define RESERVA_ALARMAS 32 // Bytes de la cola de TX que la charla no puede usar
+
+// cola_tx: productor writeUART() (programa principal), consumidor el canal 0
+// de DMA, que vuelca tramos contiguos en U1TXREG.
+// cola_rx: productor ISR de RX, consumidor getcUART() (programa principal).
 static cola_t cola_tx, cola_rx;
-static char buffer[MAX_MENSAJE];
-static int indice_buffer = 0;
+static volatile int dma_ocupado = 0;
+static volatile uint32_t tramo_dma = 0;
+
+// Contabilidad de TX. Los campos de estadisticas_tx solo los escribe el
+// productor; los descartes de líneas antiguas los hace y cuenta el consumidor.
+static politica_tx_t politica_tx = TX_DESCARTAR_NUEVO;
+static uint32_t timeout_tx_ms = 100;
+static estadisticas_tx_t estadisticas_tx;
+static volatile uint32_t bytes_a_liberar = 0; // Petición del productor
+static volatile uint32_t bytes_antiguos_descartados = 0;
+static volatile uint32_t lineas_antiguas_descartadas = 0;
+
+// Dónde acaba lo que ya ha salido por el DMA, para no descartar nunca el resto
+// de un mensaje a medio enviar. Los mensajes son líneas de texto terminadas
+// en '\n' (o "\n\r") o tramas delimitadas por dos 0x00.
+typedef enum {
+    TX_FRONTERA,   // Entre dos mensajes
+    TX_EN_LINEA,
+    TX_EN_TRAMA,
+    TX_TRAS_SALTO  // Tras un '\n': un '\r' detrás aún es de la misma línea
+} frontera_tx_t;
+
+static frontera_tx_t frontera_tx = TX_FRONTERA; // Solo la mueve el consumidor
+
+// Solo las escribe la ISR de RX
+static volatile estadisticas_rx_t estadisticas_rx;
+
+// En el bus multipunto cada byte recibido pertenece a la selección vigente
+// cuando llegó. La ISR anota cada cambio con la posición de cola_rx en la que
+// empieza, y procesarUART() los aplica al llegar a esa posición.
+typedef enum {
+    SEL_NINGUNA,  // Tráfico para otra unidad: no se recibe ni se transmite
+    SEL_PROPIA,
+    SEL_DIFUSION  // Se ejecuta pero no se responde
+} seleccion_t;
+
+typedef struct {
+    uint32_t posicion;
+    seleccion_t seleccion;
+} cambio_seleccion_t;
+
+static uint8_t direccion = DIRECCION_RS485;
+static volatile seleccion_t seleccion_rx = SEL_PROPIA; // La de la ISR
+static seleccion_t seleccion = SEL_PROPIA; // La de los bytes que se procesan
+static cambio_seleccion_t cambios[MAX_CAMBIOS_SELECCION];
+static volatile uint32_t icabeza_cambios = 0, icola_cambios = 0;
+static uint32_t baudios_reales = 0;
+static temporizador_t temporizador_autobaud;
+static volatile int rx_avisado = 0; // EV_RX publicado y aún sin atender
+static int atendiendo_peticion = 0; // Dentro de procesarUART()
+static uint8_t datos_tx[TAM_COLA_TX];
+static uint8_t datos_rx[TAM_COLA_RX];
 
 static int nueva_hora1 = 0, nueva_hora2 = 0;
 static int nueva_config_peso = 0;
 static int peso_uart = -1;
 static int hora1 = -1, min1 = -1, hora2 = -1, min2 = -1;
+static int dias1 = DIAS_TODOS, dias2 = DIAS_TODOS;
+
+static void comandoPeso(int32_t peso);
+static void comandoPrimeraComida(int32_t hhmm);
+static void comandoSegundaComida(int32_t hhmm);
+static void comandoMostrarConfig(int32_t arg);
+static void comandoClear(int32_t arg);
+static void comandoAyuda(int32_t arg);
+static void comandoBaudios(int32_t baudios);
+static void comandoAutobaud(int32_t arg);
+static void comandoSincronismo(int32_t arg);
+static void comandoPoliticaTx(int32_t politica);
+static void comandoTimeoutTx(int32_t ms);
+static void comandoEstadisticasUart(int32_t arg);
+static void comandoDireccion(int32_t arg);
+static resultado_cmd_t comandoConfig(const char *arg);
+static resultado_cmd_t comandoDiasPrimera(const char *arg);
+static resultado_cmd_t comandoDiasSegunda(const char *arg);
+
+static const comando_t comandos_uart[] = {
+    {"Peso", ARG_ENTERO, 1, 100, comandoPeso, "Peso del perro en kg", NULL},
+    {"Primera Comida", ARG_HORA, 0, 2359, comandoPrimeraComida, "Hora de la primera comida (hhmm)", NULL},
+    {"Segunda Comida", ARG_HORA, 0, 2359, comandoSegundaComida, "Hora de la segunda comida (hhmm)", NULL},
+    {"Mostrar Config", ARG_NINGUNO, 0, 0, comandoMostrarConfig, "Muestra la configuracion actual", NULL},
+    {"clear", ARG_NINGUNO, 0, 0, comandoClear, "Borra el terminal", NULL},
+    {"Ayuda", ARG_NINGUNO, 0, 0, comandoAyuda, "Lista los comandos disponibles", NULL},
+    {"Baudios", ARG_ENTERO, 1200, 1250000, comandoBaudios, "Cambia la velocidad de la UART", NULL},
+    {"Autobaud", ARG_NINGUNO, 0, 0, comandoAutobaud, "Detecta la velocidad con el siguiente 'U'", NULL},
+    {"U", ARG_NINGUNO, 0, 0, comandoSincronismo, "Caracter de sincronismo del autobaud", NULL},
+    {"Politica TX", ARG_ENTERO, 0, 2, comandoPoliticaTx, "0 descarta nuevo, 1 descarta antiguo, 2 bloquea", NULL},
+    {"Timeout TX", ARG_ENTERO, 0, 10000, comandoTimeoutTx, "Espera maxima (ms) de la politica de bloqueo", NULL},
+    {"Estadisticas UART", ARG_NINGUNO, 0, 0, comandoEstadisticasUart, "Descartes, ocupacion y bloqueos de TX", NULL},
+    {"Direccion", ARG_ENTERO, 0, 254, comandoDireccion, "Direccion en el bus RS-485 (0 punto a punto)", NULL},
+    {"Config", ARG_TEXTO, 0, 0, NULL, "Varios campos a la vez: P=kg;H1=hhmm;H2=hhmm;D1=dias;D2=dias;A=dir (- sin programar)", comandoConfig},
+    {"Dias Primera", ARG_TEXTO, 0, 0, NULL, "Dias de la primera comida: letras LMXJVSD, - ninguno", comandoDiasPrimera},
+    {"Dias Segunda", ARG_TEXTO, 0, 0, NULL, "Dias de la segunda comida: letras LMXJVSD, - ninguno", comandoDiasSegunda},
+};
+
+// Elige BRGH y BRG para minimizar el error con el reloj de periféricos real.
+// Devuelve la velocidad que se obtiene.
+static uint32_t calcularBRG(uint32_t baudios, int *brgh, uint32_t *brg) {
+    uint32_t pbclk = getFrecuenciaPeriferico();
+    uint32_t mejor_error = 0xFFFFFFFF, mejor_real = 0;
+    int h;
+
+    // Primero BRGH = 0: con el mismo error, el muestreo x16 es más robusto
+    for (h = 0; h <= 1; h++) {
+        uint32_t divisor = h ? 4 : 16;
+        uint32_t n = (pbclk + divisor * baudios / 2) / (divisor * baudios);
+        uint32_t real, error;
+
+        if (n == 0) {
+            n = 1;
+        } else if (n > 65536) {
+            n = 65536;
+        }
+        real = pbclk / (divisor * n);
+        error = real > baudios ? real - baudios : baudios - real;
+        if (error < mejor_error) {
+            mejor_error = error;
+            mejor_real = real;
+            *brgh = h;
+            *brg = n - 1;
+        }
+    }
+    return mejor_real;
+}
+
+static uint32_t errorBaudios(uint32_t pedidos, uint32_t reales) {
+    uint32_t error = reales > pedidos ? reales - pedidos : pedidos - reales;
+    return 100 * error / pedidos;
+}
+
+// Velocidad que resulta de los registros, tanto si la fijamos nosotros como
+// si la ha medido el autobaud.
+static uint32_t leerBaudios(void) {
+    uint32_t divisor = U1MODEbits.BRGH ? 4 : 16;
+    return getFrecuenciaPeriferico() / (divisor * (U1BRG + 1));
+}
+
+// Espera a que el DMA y el registro de desplazamiento hayan terminado, para
+// no cambiar la velocidad a mitad de un carácter.
+static void esperarFinTx(void) {
+    while (dma_ocupado || !U1STAbits.TRMT)
+        ;
+}
+
+#define MS_SONDEO_AUTOBAUD 50
+
+// El 'U' de sincronismo no llega a la cola de recepción, así que el fin del
+// autobaud se sondea con un temporizador mientras está en curso.
+static void comprobarAutobaud(void *dato) {
+    char mensaje[32];
+    char *p;
+
+    if (U1MODEbits.ABAUD) {
+        return;
+    }
+    pararTemporizador(&temporizador_autobaud);
+    baudios_reales = leerBaudios();
+    p = fmtCadena(mensaje, "Autobaud: ");
+    p = fmtSinSigno(p, baudios_reales);
+    p = fmtCadena(p, " baudios\n\r");
+    writeUART(mensaje, p - mensaje);
+}
 
-void InicializarUART1(int baudios) {
-    ANSELB &= ~((1 << PIN_U1RX) | (1 << PIN_U1TX));
+static void iniciarAutobaud(void) {
+    U1MODEbits.ABAUD = 1;
+    iniciarTemporizador(&temporizador_autobaud, MS_SONDEO_AUTOBAUD, MS_SONDEO_AUTOBAUD,
+                        comprobarAutobaud, NULL);
+}
+
+// Pasa de consola punto a punto a bus multipunto o viceversa según la
+// dirección. Se llama con la transmisión terminada.
+static void configurarBus(void) {
+    IEC1CLR = _IEC1_U1RXIE_MASK | _IEC1_U1EIE_MASK;
+    U1MODEbits.ON = 0;
+    if (direccion != 0) {
+        U1MODEbits.PDSEL = 3;          // 9 bits sin paridad
+        U1STASET = _U1STA_ADDEN_MASK;  // Hasta que nos direccionen, solo direcciones
+        seleccion_rx = SEL_NINGUNA;
+    } else {
+        U1MODEbits.PDSEL = 0;
+        U1STACLR = _U1STA_ADDEN_MASK | _U1STA_UTXISEL_MASK;
+        IEC1CLR = _IEC1_U1TXIE_MASK;
+        LATBCLR = 1 << PIN_DE_RS485;
+        seleccion_rx = SEL_PROPIA;
+    }
+    seleccion = seleccion_rx;
+    icola_cambios = icabeza_cambios;
+    reiniciarLinea();
+    U1MODEbits.ON = 1;
+    IEC1SET = _IEC1_U1RXIE_MASK | _IEC1_U1EIE_MASK;
+}
+
+// Con baudios = 0 arranca en modo autobaud: la velocidad se mide con el
+// primer carácter 'U' (0x55) que envíe el PC. Devuelve la velocidad real.
+uint32_t InicializarUART1(uint32_t baudios) {
+    ANSELB &= ~((1 << PIN_U1RX) | (1 << PIN_U1TX) | (1 << PIN_DE_RS485));
     TRISB |= (1 << PIN_U1RX);
+    TRISB &= ~(1 << PIN_DE_RS485);
     LATB |= (1 << PIN_U1TX);
+    LATB &= ~(1 << PIN_DE_RS485);
 
     SYSKEY = 0xAA996655;
     SYSKEY = 0x556699AA;
@@ -39,231 +251,915 @@ void InicializarUART1(int baudios) {
     RPB7R = 1;
     SYSKEY = 0x1CA11CA1;
 
-    int bdrt;
-    if (baudios <= 38400) {
-        bdrt = 5000000 / (16 * baudios) - 1;
-    } else {
-        bdrt = 5000000 / (4 * baudios) - 1;
+    inicializarCola(&cola_tx, datos_tx, TAM_COLA_TX);
+    frontera_tx = TX_FRONTERA;
+    inicializarCola(&cola_rx, datos_rx, TAM_COLA_RX);
+    registrarComandos(comandos_uart, sizeof(comandos_uart) / sizeof(comandos_uart[0]));
+
+    int brgh = 0;
+    uint32_t brg = 0;
+    if (baudios != 0) {
+        baudios_reales = calcularBRG(baudios, &brgh, &brg);
     }
-    U1BRG = bdrt;
+    U1BRG = brg;
 
     IFS1bits.U1RXIF = 0;
     IEC1bits.U1RXIE = 1;
+    IFS1bits.U1EIF = 0;
+    IEC1bits.U1EIE = 1;  // Los errores de recepción comparten vector con RX
     IFS1bits.U1TXIF = 0;
     IPC8bits.U1IP = 3;
     IPC8bits.U1IS = 1;
 
+    // Canal 0 de DMA: cada petición de TX de la UART mueve un byte de la
+    // cola a U1TXREG. Al terminar el bloque salta su interrupción.
+    DMACONbits.ON = 1;
+    DCH0CON = 0;
+    DCH0CONbits.CHPRI = 2;
+    DCH0ECON = 0;
+    DCH0ECONbits.CHSIRQ = _UART1_TX_IRQ;
+    DCH0ECONbits.SIRQEN = 1;
+    DCH0DSA = KVA_TO_PA(&U1TXREG);
+    DCH0DSIZ = 1;
+    DCH0CSIZ = 1;
+    DCH0INT = 0;
+    DCH0INTbits.CHBCIE = 1;
+    IFS1CLR = _IFS1_DMA0IF_MASK;
+    IPC10bits.DMA0IP = 3;
+    IPC10bits.DMA0IS = 0;
+    IEC1SET = _IEC1_DMA0IE_MASK;
+
+    // Interrupción con cada byte: es lo que despierta a la CPU en reposo. La
+    // ISR vacía la FIFO entera, así que en ráfagas atiende varios de golpe.
     U1STAbits.URXISEL = 0;
-    U1STAbits.UTXISEL = 2;
+    U1STAbits.UTXISEL = 0; // Petición mientras quede hueco en la FIFO de TX
     U1STAbits.URXEN = 1;
     U1STAbits.UTXEN = 1;
-    U1MODE = 0x8000;
+    U1MODE = 0x8000 | (brgh << 3); // ON y BRGH
+
+    if (direccion != 0) {
+        configurarBus();
+    }
+    if (baudios == 0) {
+        iniciarAutobaud();
+    }
+    return baudios_reales;
 }
 
-void putsUART(char s[]) {
-    int indice = 0;
-    asm("di");
-    while (s[indice] != '\0') {
-        if (((cola_tx.icabeza + 1) == cola_tx.icola) ||
-            ((cola_tx.icabeza + 1) == TAM_COLA && cola_tx.icola == 0)) {
-            break;
-        } else {
-            cola_tx.datos[cola_tx.icabeza] = s[indice];
-            indice++;
-            cola_tx.icabeza++;
+void setDireccionUART(uint8_t nueva) {
+    esperarFinTx();
+    direccion = nueva;
+    configurarBus();
+}
 
-            if (cola_tx.icabeza == TAM_COLA) {
-                cola_tx.icabeza = 0;
-            }
+uint8_t getDireccionUART(void) {
+    return direccion;
+}
+
+uint32_t getBaudiosUART(void) {
+    return baudios_reales;
+}
+
+static frontera_tx_t avanzarFrontera(frontera_tx_t e, uint8_t c) {
+    if (e == TX_EN_TRAMA) {
+        return c == 0 ? TX_FRONTERA : TX_EN_TRAMA;
+    }
+    if (e == TX_TRAS_SALTO && c == '\r') {
+        return TX_FRONTERA;
+    }
+    if (e != TX_EN_LINEA && c == 0) {
+        return TX_EN_TRAMA;
+    }
+    return c == '\n' ? TX_TRAS_SALTO : TX_EN_LINEA;
+}
+
+// Si con el estado e y lo que queda en la cola se está entre dos mensajes.
+static int esFrontera(frontera_tx_t e) {
+    uint8_t *p;
+
+    if (e != TX_TRAS_SALTO) {
+        return e == TX_FRONTERA;
+    }
+    return colaTramoLectura(&cola_tx, &p) == 0 || *p != '\r';
+}
+
+// Bytes de p[0..n) hasta el final del mensaje que está saliendo, o n.
+static uint32_t hastaFinDeMensaje(const uint8_t *p, uint32_t n) {
+    frontera_tx_t e = frontera_tx;
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        e = avanzarFrontera(e, p[i]);
+        if (e == TX_FRONTERA || (e == TX_TRAS_SALTO && i + 1 < n && p[i + 1] != '\r')) {
+            return i + 1;
         }
     }
-    asm("ei");
-    IEC1bits.U1TXIE = 1;
+    return n;
 }
 
-char getcUART(void) {
-    char c;
-    asm("di");
-    if (cola_rx.icola != cola_rx.icabeza) {
-        c = cola_rx.datos[cola_rx.icola];
-        cola_rx.icola++;
-        if (cola_rx.icola == TAM_COLA) {
-            cola_rx.icola = 0;
+// Atiende una petición de TX_DESCARTAR_ANTIGUO desde el lado consumidor, que
+// es el único que puede mover la cola. Solo se llama entre dos mensajes, y se
+// descartan mensajes completos hasta liberar lo pedido.
+static void descartarAntiguos(void) {
+    uint32_t liberados = 0;
+    uint8_t c;
+
+    while (liberados < bytes_a_liberar && colaLeerByte(&cola_tx, &c)) {
+        frontera_tx_t e = avanzarFrontera(TX_FRONTERA, c);
+
+        liberados++;
+        while (!esFrontera(e) && colaLeerByte(&cola_tx, &c)) {
+            e = avanzarFrontera(e, c);
+            liberados++;
         }
-    } else {
+        lineas_antiguas_descartadas++;
+    }
+    frontera_tx = TX_FRONTERA;
+    bytes_antiguos_descartados += liberados;
+    bytes_a_liberar = 0;
+}
+
+// Programa el DMA con el siguiente tramo contiguo de la cola de TX. Solo se
+// llama con el canal parado: desde writeUART() cuando no hay DMA en curso y
+// desde la interrupción de fin de bloque.
+static void arrancarDMA(void) {
+    uint8_t *p;
+    uint32_t n;
+
+    if (bytes_a_liberar != 0 && esFrontera(frontera_tx)) {
+        descartarAntiguos();
+    }
+    n = colaTramoLectura(&cola_tx, &p);
+    if (n > MAX_TRAMO_DMA) {
+        n = MAX_TRAMO_DMA;
+    }
+    if (bytes_a_liberar != 0) {
+        // A mitad de un mensaje: se termina de enviar y se descarta al acabar
+        n = hastaFinDeMensaje(p, n);
+    }
+    if (n == 0) {
+        // En el bus se suelta el driver cuando sale el último bit de parada:
+        // se pide la interrupción de TX con el registro de desplazamiento vacío.
+        if (direccion != 0) {
+            U1STASET = 1 << _U1STA_UTXISEL_POSITION; // UTXISEL = 01
+            IFS1CLR = _IFS1_U1TXIF_MASK;
+            IEC1SET = _IEC1_U1TXIE_MASK;
+        }
+        dma_ocupado = 0;
+        return;
+    }
+    if (direccion != 0) {
+        IEC1CLR = _IEC1_U1TXIE_MASK;
+        U1STACLR = _U1STA_UTXISEL_MASK; // De nuevo peticiones para el DMA
+        LATBSET = 1 << PIN_DE_RS485;
+    }
+    dma_ocupado = 1;
+    tramo_dma = n;
+    DCH0SSA = KVA_TO_PA(p);
+    DCH0SSIZ = n;
+    DCH0INTCLR = 0xFF;
+    DCH0CONbits.CHEN = 1;
+    DCH0ECONbits.CFORCE = 1; // El primer byte se fuerza; el resto lo pide la UART
+}
+
+static int hayHuecoTx(uint32_t len, uint32_t reserva) {
+    return colaLibre(&cola_tx) >= len + reserva;
+}
+
+// Espera a que el DMA libere hueco. Devuelve 1 si lo hay antes del timeout.
+static int esperarHuecoTx(uint32_t len, uint32_t reserva, uint32_t timeout_ms) {
+    uint32_t inicio = getTiempoAbsoluto();
+    uint32_t transcurrido = 0;
+    int hueco;
+
+    while (!(hueco = hayHuecoTx(len, reserva)) && transcurrido < timeout_ms) {
+        transcurrido = getTiempoAbsoluto() - inicio;
+    }
+    estadisticas_tx.ms_bloqueado += transcurrido;
+    return hueco;
+}
+
+// Tiempo en ms que tarda el DMA en soltar un tramo completo. Un descarte puede
+// tener que esperar a dos: el que está saliendo y el resto de su mensaje.
+static uint32_t msPorTramo(void) {
+    uint32_t baudios = baudios_reales ? baudios_reales : 1200;
+    return MAX_TRAMO_DMA * 10 * 1000 / baudios + 2;
+}
+
+uint32_t writeUARTPrioridad(const void *buf, uint32_t len, prioridad_tx_t prioridad) {
+    uint32_t reserva = prioridad == PRIO_ALARMA ? 0 : RESERVA_ALARMAS;
+    int hueco = hayHuecoTx(len, reserva);
+    uint32_t ocupacion;
+
+    // En el bus solo se habla para responder a una petición dirigida a esta
+    // unidad, mientras se atiende: quedar seleccionada no da permiso después
+    if (seleccion != SEL_PROPIA || (direccion != 0 && !atendiendo_peticion)) {
+        return 0;
+    }
+    if (!hueco && len + reserva <= TAM_COLA_TX && dma_ocupado) {
+        if (politica_tx == TX_BLOQUEAR) {
+            hueco = esperarHuecoTx(len, reserva, timeout_tx_ms);
+        } else if (politica_tx == TX_DESCARTAR_ANTIGUO) {
+            bytes_a_liberar = len + reserva - colaLibre(&cola_tx);
+            hueco = esperarHuecoTx(len, reserva, 2 * msPorTramo());
+            bytes_a_liberar = 0;
+        }
+    }
+    if (!hueco) {
+        estadisticas_tx.bytes_descartados += len;
+        estadisticas_tx.mensajes_descartados++;
+        return 0;
+    }
+
+    colaEscribir(&cola_tx, buf, len);
+    ocupacion = colaOcupada(&cola_tx);
+    if (ocupacion > estadisticas_tx.max_ocupacion) {
+        estadisticas_tx.max_ocupacion = ocupacion;
+    }
+    if (!dma_ocupado) {
+        arrancarDMA();
+    }
+    return len;
+}
+
+uint32_t writeUART(const void *buf, uint32_t len) {
+    return writeUARTPrioridad(buf, len, PRIO_CHARLA);
+}
+
+void putsUART(char s[]) {
+    writeUART(s, strlen(s));
+}
+
+void putsAlarmaUART(char s[]) {
+    writeUARTPrioridad(s, strlen(s), PRIO_ALARMA);
+}
+
+void setPoliticaTxUART(politica_tx_t politica, uint32_t timeout_ms) {
+    politica_tx = politica;
+    timeout_tx_ms = timeout_ms;
+}
+
+void getEstadisticasRxUART(estadisticas_rx_t *estadisticas) {
+    estadisticas->desbordamientos = estadisticas_rx.desbordamientos;
+    estadisticas->errores_trama = estadisticas_rx.errores_trama;
+    estadisticas->errores_paridad = estadisticas_rx.errores_paridad;
+    estadisticas->bytes_perdidos = estadisticas_rx.bytes_perdidos;
+}
+
+void getEstadisticasTxUART(estadisticas_tx_t *estadisticas) {
+    *estadisticas = estadisticas_tx;
+    estadisticas->bytes_descartados += bytes_antiguos_descartados;
+    estadisticas->mensajes_descartados += lineas_antiguas_descartadas;
+}
+
+char getcUART(void) {
+    uint8_t c;
+
+    if (!colaLeerByte(&cola_rx, &c)) {
         c = '\0';
     }
-    asm("ei");
     return c;
 }
 
+static void informarResultado(resultado_cmd_t resultado) {
+    switch (resultado) {
+        case CMD_DESCONOCIDO:
+            putsUART("ERR comando desconocido\n\r");
+            break;
+        case CMD_FORMATO:
+            putsUART("ERR formato\n\r");
+            break;
+        case CMD_RANGO:
+            putsUART("ERR fuera de rango\n\r");
+            break;
+        case CMD_CONFLICTO:
+            putsUART("ERR conflicto de horario\n\r");
+            break;
+        case CMD_DEMASIADO_LARGA:
+            putsUART("ERR linea demasiado larga\n\r");
+            break;
+        default:
+            break;
+    }
+}
+
+// Aplica los cambios de selección que empiezan en el siguiente byte a leer.
+static void aplicarCambiosSeleccion(void) {
+    while (icola_cambios != icabeza_cambios) {
+        cambio_seleccion_t *cambio = &cambios[icola_cambios & (MAX_CAMBIOS_SELECCION - 1)];
+
+        if (cambio->posicion != cola_rx.icola) {
+            break;
+        }
+        seleccion = cambio->seleccion;
+        reiniciarLinea(); // Una línea a medias era para otro destinatario
+        protocoloReiniciar();
+        icola_cambios++;
+    }
+}
+
+// Se atiende cada vez que la ISR publica EV_RX. El aviso se rearma antes de
+// vaciar la cola, así que un byte que llegue mientras tanto vuelve a avisar.
+void procesarUART(void) {
+    uint8_t c;
+
+    rx_avisado = 0;
+    atendiendo_peticion = 1;
+    // No se usa getcUART(): el 0x00 es el delimitador de las tramas binarias
+    aplicarCambiosSeleccion();
+    while (colaLeerByte(&cola_rx, &c)) {
+        destino_byte_t destino = protocoloRecibirByte(c);
+        const uint8_t *texto;
+        int n = protocoloTextoDevuelto(&texto);
+        int i;
+
+        for (i = 0; i < n; i++) {
+            informarResultado(recibirByteLinea(texto[i]));
+        }
+        if (destino == BYTE_TEXTO) {
+            informarResultado(recibirByteLinea(c));
+        }
+        aplicarCambiosSeleccion();
+    }
+    atendiendo_peticion = 0;
+}
+
+// Letras de los días en el orden de dia_semana (0 domingo)
+static const char letras_dias[7] = {'D', 'L', 'M', 'X', 'J', 'V', 'S'};
+
+// " (LMXJV)", en orden de lunes a domingo; nada si son todos los días.
+static char *fmtDias(char *p, int dias) {
+    int i;
+
+    if (dias == DIAS_TODOS) {
+        return p;
+    }
+    *p++ = ' ';
+    *p++ = '(';
+    for (i = 1; i <= 7; i++) {
+        if (dias & (1 << (i % 7))) {
+            *p++ = letras_dias[i % 7];
+        }
+    }
+    if (dias == 0) {
+        *p++ = '-';
+    }
+    *p++ = ')';
+    *p = '\0';
+    return p;
+}
+
 void enviarConfiguracionUART(void) {
-    char mensaje[64];
+    char mensaje[256];
+    char *p;
     uint32_t peso_actual = getPeso();
     uint32_t racion_actual = getRacion()*2;
 
-    sprintf(mensaje, "\n----- CONFIGURACION ACTUAL -----\n\r");
-    putsUART(mensaje);
+    // Se compone entero y se encola de una vez
+    p = fmtCadena(mensaje, "\n----- CONFIGURACION ACTUAL -----\n\r");
 
-    sprintf(mensaje, " Peso configurado: %lu kg\n\r", peso_actual);
-    putsUART(mensaje);
+    p = fmtCadena(p, " Peso configurado: ");
+    p = fmtSinSigno(p, peso_actual);
+    p = fmtCadena(p, " kg\n\r");
 
-    sprintf(mensaje, " Racion diaria: %lu g\n\r", racion_actual);
-    putsUART(mensaje);
+    p = fmtCadena(p, " Racion diaria: ");
+    p = fmtSinSigno(p, racion_actual);
+    p = fmtCadena(p, " g\n\r");
 
+    p = fmtCadena(p, " Primera comida: ");
     if (hora1 >= 0 && min1 >= 0) {
-        sprintf(mensaje, " Primera comida: %02d:%02d\n\r", hora1, min1);
-        putsUART(mensaje);
+        p = fmtHora(p, hora1, min1);
+        p = fmtDias(p, dias1);
     } else {
-        sprintf(mensaje, " Primera comida: No programada\n\r");
-        putsUART(mensaje);
+        p = fmtCadena(p, "No programada");
     }
+    p = fmtCadena(p, "\n\r");
 
+    p = fmtCadena(p, " Segunda comida: ");
     if (hora2 >= 0 && min2 >= 0) {
-        sprintf(mensaje, " Segunda comida: %02d:%02d\n\r", hora2, min2);
-        putsUART(mensaje);
+        p = fmtHora(p, hora2, min2);
+        p = fmtDias(p, dias2);
     } else {
-        sprintf(mensaje, " Segunda comida: No programada\n\r");
-        putsUART(mensaje);
+        p = fmtCadena(p, "No programada");
     }
+    p = fmtCadena(p, "\n\r");
 
+    p = fmtCadena(p, " Direccion RS-485: ");
+    if (direccion != 0) {
+        p = fmtSinSigno(p, direccion);
+    } else {
+        p = fmtCadena(p, "punto a punto");
+    }
+    p = fmtCadena(p, "\n\r");
 
-    sprintf(mensaje, "--------------------------------\n\r\n");
-    putsUART(mensaje);
+    p = fmtCadena(p, "--------------------------------\n\r\n");
+    writeUART(mensaje, p - mensaje);
 }
 
 void clearUart(void){
     putsUART("\033[2J\033[H");
 }
 
-void __attribute__((vector(32), interrupt(IPL3SOFT), nomips16)) InterrupcionUART1(void) {
-    if (IFS1bits.U1RXIF == 1) {
-        char c = U1RXREG;
-        char mensaje[64];
-        if (c == '\n' || c == '\r') {
-            buffer[indice_buffer] = '\0';
-            asm("di");
-            if (strncmp(buffer, "Peso:", 5) == 0) {
-                peso_uart = atoi(&buffer[5]);
-                nueva_config_peso = 1;
-            } else if (strncmp(buffer, "Primera Comida:", 15) == 0) {
-                int t = atoi(&buffer[15]);
-                hora1 = t / 100;
-                min1 = t % 100;
-                nueva_hora1 = 1;
-            } else if (strncmp(buffer, "Segunda Comida:", 15) == 0) {
-                int t = atoi(&buffer[15]);
-                hora2 = t / 100;
-                min2 = t % 100;
-                nueva_hora2 = 1;
-            }else if (strncmp(buffer, "Mostrar Config", 14) == 0) {
-                enviarConfiguracionUART();
-            }else if (strncmp(buffer, "Hora", 4) == 0) {
-                int h = getHoraActual();
-                int m = getMinutoActual();
-                int s = getSegundos();
-                sprintf(mensaje, "Hora actual: %02d:%02d:%02d\n\r", h, m, s);
-                putsUART(mensaje);
-            } else if (strncmp(buffer, "clear", 5) == 0) {
-                clearUart(); 
+void getConfiguracion(config_t *config) {
+    config->peso = peso_uart >= 0 ? peso_uart : (int) getPeso();
+    config->hora1 = hora1;
+    config->min1 = min1;
+    config->hora2 = hora2;
+    config->min2 = min2;
+    config->dias1 = dias1;
+    config->dias2 = dias2;
+    config->direccion = direccion;
+}
+
+resultado_cmd_t setConfiguracion(const config_t *config) {
+    if (config->peso < 1 || config->peso > 100) {
+        return CMD_RANGO;
+    }
+    if ((config->hora1 >= 0 && !esHoraValida(config->hora1 * 100 + config->min1)) ||
+        (config->hora2 >= 0 && !esHoraValida(config->hora2 * 100 + config->min2))) {
+        return CMD_RANGO;
+    }
+    if (config->dias1 & ~DIAS_TODOS || config->dias2 & ~DIAS_TODOS) {
+        return CMD_RANGO;
+    }
+    if (config->direccion < 0 || config->direccion >= DIRECCION_DIFUSION) {
+        return CMD_RANGO;
+    }
+    // Dos comidas en el mismo minuto de un mismo día dispensarían dos
+    // raciones seguidas
+    if (config->hora1 >= 0 && config->hora1 == config->hora2 && config->min1 == config->min2 &&
+        (config->dias1 & config->dias2)) {
+        return CMD_CONFLICTO;
+    }
+
+    if (config->peso != peso_uart) {
+        peso_uart = config->peso;
+        nueva_config_peso = 1;
+    }
+    if (config->hora1 != hora1 || config->min1 != min1 || config->dias1 != dias1) {
+        hora1 = config->hora1;
+        min1 = config->min1;
+        dias1 = config->dias1;
+        nueva_hora1 = 1;
+    }
+    if (config->hora2 != hora2 || config->min2 != min2 || config->dias2 != dias2) {
+        hora2 = config->hora2;
+        min2 = config->min2;
+        dias2 = config->dias2;
+        nueva_hora2 = 1;
+    }
+    publicarEvento(EV_CONFIG, 0);
+    if (config->direccion != direccion) {
+        setDireccionUART(config->direccion);
+    }
+    return CMD_OK;
+}
+
+// Lee un valor "hhmm" o "-" (sin programar) de un campo de Config.
+static resultado_cmd_t leerHoraConfig(const char *valor, int *h, int *m) {
+    int32_t hhmm;
+
+    if (valor[0] == '-' && valor[1] == '\0') {
+        *h = -1;
+        *m = -1;
+        return CMD_OK;
+    }
+    if (!leerEntero(valor, &hhmm)) {
+        return CMD_FORMATO;
+    }
+    if (!esHoraValida(hhmm)) {
+        return CMD_RANGO;
+    }
+    *h = hhmm / 100;
+    *m = hhmm % 100;
+    return CMD_OK;
+}
+
+// Lee una máscara de días escrita con sus letras ("LMXJV") o "-" (ninguno).
+static resultado_cmd_t leerDias(const char *valor, int *dias) {
+    int mascara = 0;
+    int i;
+
+    while (*valor == ' ') {
+        valor++;
+    }
+    if (valor[0] == '-' && valor[1] == '\0') {
+        *dias = 0;
+        return CMD_OK;
+    }
+    if (*valor == '\0') {
+        return CMD_FORMATO;
+    }
+    for (; *valor != '\0'; valor++) {
+        for (i = 0; i < 7; i++) {
+            if (letras_dias[i] == (*valor & ~0x20)) {
+                break;
             }
-            asm("ei");
-            indice_buffer = 0;
-        } else if (indice_buffer < MAX_MENSAJE - 1) {
-            buffer[indice_buffer++] = c;
         }
-        IFS1bits.U1RXIF = 0;
+        if (i == 7) {
+            return CMD_FORMATO;
+        }
+        mascara |= 1 << i;
     }
+    *dias = mascara;
+    return CMD_OK;
+}
 
-    if (IFS1bits.U1TXIF == 1) {
-        if (cola_tx.icabeza != cola_tx.icola) {
-            U1TXREG = cola_tx.datos[cola_tx.icola];
-            cola_tx.icola++;
-            if (cola_tx.icola == TAM_COLA) {
-                cola_tx.icola = 0;
-            }
+// "P=12;H1=0830;H2=1900;A=5": los campos son opcionales y van en cualquier orden.
+// Los que no aparecen conservan su valor.
+static resultado_cmd_t comandoConfig(const char *arg) {
+    config_t config;
+    char campo[MAX_LINEA];
+    int vistos = 0;
+
+    getConfiguracion(&config);
+    while (*arg != '\0') {
+        const char *fin = strchr(arg, ';');
+        int longitud = fin ? fin - arg : (int) strlen(arg);
+        char *valor;
+        int bit;
+        resultado_cmd_t res;
+
+        if (longitud >= (int) sizeof(campo)) {
+            return CMD_FORMATO;
+        }
+        memcpy(campo, arg, longitud);
+        campo[longitud] = '\0';
+        arg += fin ? longitud + 1 : longitud;
+
+        valor = strchr(campo, '=');
+        if (valor == NULL) {
+            return CMD_FORMATO;
+        }
+        *valor++ = '\0';
+        if (strcmp(campo, "P") == 0) {
+            int32_t peso = 0;
+
+            bit = 1;
+            res = leerEntero(valor, &peso) ? CMD_OK : CMD_FORMATO;
+            config.peso = peso;
+        } else if (strcmp(campo, "H1") == 0) {
+            bit = 2;
+            res = leerHoraConfig(valor, &config.hora1, &config.min1);
+        } else if (strcmp(campo, "H2") == 0) {
+            bit = 4;
+            res = leerHoraConfig(valor, &config.hora2, &config.min2);
+        } else if (strcmp(campo, "D1") == 0) {
+            bit = 8;
+            res = leerDias(valor, &config.dias1);
+        } else if (strcmp(campo, "D2") == 0) {
+            bit = 16;
+            res = leerDias(valor, &config.dias2);
+        } else if (strcmp(campo, "A") == 0) {
+            int32_t dir = 0;
+
+            bit = 32;
+            res = leerEntero(valor, &dir) ? CMD_OK : CMD_FORMATO;
+            config.direccion = dir;
         } else {
-            IEC1bits.U1TXIE = 0;
+            return CMD_FORMATO;
+        }
+        if (res != CMD_OK) {
+            return res;
+        }
+        if (vistos & bit) {
+            return CMD_FORMATO; // Campo repetido
+        }
+        vistos |= bit;
+    }
+    if (vistos == 0) {
+        return CMD_FORMATO;
+    }
+    return setConfiguracion(&config);
+}
+
+// Los comandos de un solo campo son transacciones de un campo.
+static void aplicarCampo(config_t *config) {
+    if (setConfiguracion(config) == CMD_CONFLICTO) {
+        putsUART("ERR conflicto de horario\n\r");
+    }
+}
+
+static void comandoPeso(int32_t peso) {
+    config_t config;
+
+    getConfiguracion(&config);
+    config.peso = peso;
+    aplicarCampo(&config);
+}
+
+static void comandoPrimeraComida(int32_t hhmm) {
+    config_t config;
+
+    getConfiguracion(&config);
+    config.hora1 = hhmm / 100;
+    config.min1 = hhmm % 100;
+    aplicarCampo(&config);
+}
+
+static void comandoSegundaComida(int32_t hhmm) {
+    config_t config;
+
+    getConfiguracion(&config);
+    config.hora2 = hhmm / 100;
+    config.min2 = hhmm % 100;
+    aplicarCampo(&config);
+}
+
+static resultado_cmd_t comandoDiasPrimera(const char *arg) {
+    config_t config;
+    resultado_cmd_t res;
+
+    getConfiguracion(&config);
+    res = leerDias(arg, &config.dias1);
+    return res == CMD_OK ? setConfiguracion(&config) : res;
+}
+
+static resultado_cmd_t comandoDiasSegunda(const char *arg) {
+    config_t config;
+    resultado_cmd_t res;
+
+    getConfiguracion(&config);
+    res = leerDias(arg, &config.dias2);
+    return res == CMD_OK ? setConfiguracion(&config) : res;
+}
+
+static void comandoMostrarConfig(int32_t arg) {
+    enviarConfiguracionUART();
+}
+
+static void comandoClear(int32_t arg) {
+    clearUart();
+}
+
+// Listado legible por máquina: una línea por comando con sus campos
+// separados por ';'.
+static void comandoAyuda(int32_t arg) {
+    static const char *tipos[] = {"ninguno", "entero", "hora", "texto"};
+    char mensaje[128];
+    char *p;
+    int i;
+
+    putsUART("#comando;argumento;min;max;descripcion\n\r");
+    for (i = 0; i < getNumComandos(); i++) {
+        const comando_t *cmd = getComando(i);
+
+        p = fmtCadena(mensaje, cmd->nombre);
+        p = fmtCadena(p, ";");
+        p = fmtCadena(p, tipos[cmd->tipo]);
+        p = fmtCadena(p, ";");
+        p = fmtEntero(p, cmd->min);
+        p = fmtCadena(p, ";");
+        p = fmtEntero(p, cmd->max);
+        p = fmtCadena(p, ";");
+        p = fmtCadena(p, cmd->ayuda);
+        p = fmtCadena(p, "\n\r");
+        writeUART(mensaje, p - mensaje);
+    }
+}
+
+static void comandoBaudios(int32_t baudios) {
+    char mensaje[48];
+    char *p;
+    int brgh;
+    uint32_t brg;
+    uint32_t reales = calcularBRG(baudios, &brgh, &brg);
+    uint32_t error = errorBaudios(baudios, reales);
+
+    p = fmtCadena(mensaje, error > MAX_ERROR_BAUDIOS ? "ERR baudios: " : "Baudios: ");
+    p = fmtSinSigno(p, reales);
+    p = fmtCadena(p, " (error ");
+    p = fmtSinSigno(p, error);
+    p = fmtCadena(p, "%)\n\r");
+    writeUART(mensaje, p - mensaje);
+    if (error > MAX_ERROR_BAUDIOS) {
+        return;
+    }
+
+    esperarFinTx();
+    U1MODEbits.ON = 0;
+    U1BRG = brg;
+    U1MODEbits.BRGH = brgh;
+    U1MODEbits.ON = 1;
+    baudios_reales = reales;
+}
+
+static void comandoAutobaud(int32_t arg) {
+    putsUART("Autobaud: envie 'U' a la nueva velocidad\n\r");
+    esperarFinTx();
+    iniciarAutobaud();
+}
+
+// El 'U' del autobaud puede llegar también como carácter: se acepta en
+// silencio para que no genere un error.
+static void comandoSincronismo(int32_t arg) {
+}
+
+static void comandoPoliticaTx(int32_t politica) {
+    politica_tx = politica;
+}
+
+static void comandoTimeoutTx(int32_t ms) {
+    timeout_tx_ms = ms;
+}
+
+static void comandoEstadisticasUart(int32_t arg) {
+    estadisticas_tx_t e;
+    estadisticas_rx_t r;
+    char mensaje[240];
+    char *p;
+
+    getEstadisticasTxUART(&e);
+    getEstadisticasRxUART(&r);
+    p = fmtCadena(mensaje, "TX politica: ");
+    p = fmtSinSigno(p, politica_tx);
+    p = fmtCadena(p, "\n\rTX descartados: ");
+    p = fmtSinSigno(p, e.bytes_descartados);
+    p = fmtCadena(p, " bytes, ");
+    p = fmtSinSigno(p, e.mensajes_descartados);
+    p = fmtCadena(p, " mensajes\n\rTX max ocupacion: ");
+    p = fmtSinSigno(p, e.max_ocupacion);
+    p = fmtCadena(p, "/");
+    p = fmtSinSigno(p, TAM_COLA_TX);
+    p = fmtCadena(p, "\n\rTX bloqueado: ");
+    p = fmtSinSigno(p, e.ms_bloqueado);
+    p = fmtCadena(p, " ms\n\rRX desbordamientos: ");
+    p = fmtSinSigno(p, r.desbordamientos);
+    p = fmtCadena(p, "\n\rRX errores trama/paridad: ");
+    p = fmtSinSigno(p, r.errores_trama);
+    p = fmtCadena(p, "/");
+    p = fmtSinSigno(p, r.errores_paridad);
+    p = fmtCadena(p, "\n\rRX perdidos en cola: ");
+    p = fmtSinSigno(p, r.bytes_perdidos);
+    p = fmtCadena(p, "\n\r");
+    writeUARTPrioridad(mensaje, p - mensaje, PRIO_ALARMA);
+}
+
+static void comandoDireccion(int32_t arg) {
+    config_t config;
+    char mensaje[32];
+    char *p;
+
+    p = fmtCadena(mensaje, "Direccion: ");
+    p = fmtSinSigno(p, arg);
+    p = fmtCadena(p, "\n\r");
+    writeUART(mensaje, p - mensaje);
+    getConfiguracion(&config);
+    config.direccion = arg;
+    aplicarCampo(&config);
+}
+
+// Llega un carácter de dirección. Si no es para nosotros se vuelve a ADDEN y
+// el hardware descarta los datos sin interrumpir hasta la siguiente dirección.
+static void recibirDireccion(uint8_t destino) {
+    seleccion_t nueva = SEL_NINGUNA;
+
+    if (destino == direccion) {
+        nueva = SEL_PROPIA;
+    } else if (destino == DIRECCION_DIFUSION) {
+        nueva = SEL_DIFUSION;
+    }
+    if (nueva == seleccion_rx) {
+        return;
+    }
+    if (icabeza_cambios - icola_cambios >= MAX_CAMBIOS_SELECCION) {
+        // No se puede anotar el cambio: se ignora el mensaje entero
+        estadisticas_rx.bytes_perdidos++;
+        U1STASET = _U1STA_ADDEN_MASK;
+        seleccion_rx = SEL_NINGUNA;
+        return;
+    }
+    if (nueva == SEL_NINGUNA) {
+        U1STASET = _U1STA_ADDEN_MASK;
+    } else {
+        U1STACLR = _U1STA_ADDEN_MASK;
+    }
+    cambios[icabeza_cambios & (MAX_CAMBIOS_SELECCION - 1)].posicion = cola_rx.icabeza;
+    cambios[icabeza_cambios & (MAX_CAMBIOS_SELECCION - 1)].seleccion = nueva;
+    BARRERA_MEMORIA();
+    icabeza_cambios++;
+    seleccion_rx = nueva;
+}
+
+void __attribute__((vector(32), interrupt(IPL3SOFT), nomips16)) InterrupcionUART1(void) {
+    PERFIL_INICIO(PERFIL_ISR_UART);
+
+    if (IFS1bits.U1RXIF == 1 || IFS1bits.U1EIF == 1) {
+        // Se vacía toda la FIFO. FERR y PERR se refieren al carácter que está
+        // en cabeza, así que se comprueban antes de leer cada uno.
+        while (U1STAbits.URXDA) {
+            if (U1STAbits.FERR) {
+                estadisticas_rx.errores_trama++;
+                (void) U1RXREG;
+            } else if (U1STAbits.PERR) {
+                estadisticas_rx.errores_paridad++;
+                (void) U1RXREG;
+            } else {
+                uint32_t dato = U1RXREG;
+
+                if (direccion != 0 && (dato & BIT_DIRECCION)) {
+                    recibirDireccion(dato);
+                } else if (seleccion_rx == SEL_NINGUNA) {
+                    // Datos para otra unidad que ya estaban en la FIFO
+                } else if (!colaEscribirByte(&cola_rx, dato)) {
+                    estadisticas_rx.bytes_perdidos++; // El consumidor va retrasado
+                }
+            }
+        }
+        // Un solo aviso hasta que procesarUART() vacíe la cola. Las
+        // direcciones también avisan: cambian la selección de la unidad.
+        if (!rx_avisado) {
+            rx_avisado = publicarEvento(EV_RX, 0) > 0;
         }
-        IFS1bits.U1TXIF = 0;
+        // Con OERR activo la UART deja de recibir hasta que se borra
+        if (U1STAbits.OERR) {
+            estadisticas_rx.desbordamientos++;
+            U1STACLR = _U1STA_OERR_MASK;
+        }
+        IFS1CLR = _IFS1_U1RXIF_MASK | _IFS1_U1EIF_MASK;
+    }
+    // Fin de transmisión en el bus: se libera la línea para las demás unidades
+    if (IEC1bits.U1TXIE && IFS1bits.U1TXIF) {
+        IEC1CLR = _IEC1_U1TXIE_MASK;
+        IFS1CLR = _IFS1_U1TXIF_MASK;
+        LATBCLR = 1 << PIN_DE_RS485;
+    }
+    PERFIL_FIN(PERFIL_ISR_UART);
+}
+
+void __attribute__((vector(_DMA_0_VECTOR), interrupt(IPL3SOFT), nomips16)) InterrupcionDMA0(void) {
+    uint8_t *p;
+    uint32_t i;
+
+    DCH0INTCLR = 0xFF;
+    IFS1CLR = _IFS1_DMA0IF_MASK;
+
+    colaTramoLectura(&cola_tx, &p);
+    for (i = 0; i < tramo_dma; i++) {
+        frontera_tx = avanzarFrontera(frontera_tx, p[i]);
     }
+    colaConsumir(&cola_tx, tramo_dma);
+    arrancarDMA();
+}
+
+uint32_t getOcupacionTxUART(void) {
+    return colaOcupada(&cola_tx);
+}
+
+uint32_t getOcupacionRxUART(void) {
+    return colaOcupada(&cola_rx);
 }
 
 int hayNuevoPeso(void) {
     int res;
-    asm("di");
     res = nueva_config_peso;
     nueva_config_peso = 0;
-    asm("ei");
     return res;
 }
 
 int getPesoUART(void) {
-    int p;
-    asm("di");
-    p = peso_uart;
-    asm("ei");
-    return p;
+    return peso_uart;
 }
 
 int hayPrimeraHoraNueva(void) {
     int res;
-    asm("di");
     res = nueva_hora1;
     nueva_hora1 = 0;
-    asm("ei");
     return res;
 }
 
 int getHoraPrimera(void) {
-    int h;
-    asm("di");
-    h = hora1;
-    asm("ei");
-    return h;
+    return hora1;
 }
 
 int getMinPrimera(void) {
-    int m;
-    asm("di");
-    m = min1;
-    asm("ei");
-    return m;
+    return min1;
 }
 
 int haySegundaHoraNueva(void) {
     int res;
-    asm("di");
     res = nueva_hora2;
     nueva_hora2 = 0;
-    asm("ei");
     return res;
 }
 
 int getHoraSegunda(void) {
-    int h;
-    asm("di");
-    h = hora2;
-    asm("ei");
-    return h;
+    return hora2;
 }
 
 int getMinSegunda(void) {
-    int m;
-    asm("di");
-    m = min2;
-    asm("ei");
-    return m;
+    return min2;
 }
 
 
 void apagarUart(){
     U1MODE &= ~(0x8000);
     IEC1bits.U1RXIE = 0;  // Apaga interrupción RX
-    IEC1bits.U1TXIE = 0;  // Apaga interrupción TX
+    DCH0CONbits.CHEN = 0; // Detiene el DMA de TX
+    dma_ocupado = 0;
 }
 void encenderUart(){
     U1MODE |= 0x8000;
-    IEC1bits.U1RXIE = 1;  // Apaga interrupción RX
-    IEC1bits.U1TXIE = 1;
+    IEC1bits.U1RXIE = 1;  // Enciende interrupción RX
+    arrancarDMA();        // Reanuda el envío de lo que quedase en la cola
 }
\ No newline at end of file
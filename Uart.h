@@ -1,10 +1,83 @@
 #ifndef UART_H
 #define UART_H
 
-void InicializarUART1(int baudios);
+#include <stdint.h>
+#include "Comandos.h"
+
+// Qué hacer cuando un mensaje no cabe en la cola de TX. Los mensajes nunca se
+// truncan: o entran enteros o se descartan y se contabilizan.
+typedef enum {
+    TX_DESCARTAR_NUEVO,   // Se descarta el mensaje que no cabe
+    TX_DESCARTAR_ANTIGUO, // Se descartan las líneas más antiguas pendientes
+    TX_BLOQUEAR           // Se espera hueco hasta el timeout; luego se descarta
+} politica_tx_t;
+
+// Las alarmas pueden usar toda la cola; la charla deja libre una reserva
+// para que una ráfaga de trazas nunca impida enviar una alarma.
+typedef enum {
+    PRIO_CHARLA,
+    PRIO_ALARMA
+} prioridad_tx_t;
+
+typedef struct {
+    uint32_t bytes_descartados;
+    uint32_t mensajes_descartados;
+    uint32_t max_ocupacion;     // Marca de agua alta de la cola de TX
+    uint32_t ms_bloqueado;      // Tiempo total esperando hueco
+} estadisticas_tx_t;
+
+typedef struct {
+    uint32_t desbordamientos;   // OERR: la FIFO hardware se llenó
+    uint32_t errores_trama;     // FERR (incluye los break)
+    uint32_t errores_paridad;   // PERR
+    uint32_t bytes_perdidos;    // Cola de RX llena
+} estadisticas_rx_t;
+
+// Bus RS-485 multipunto: con dirección distinta de 0 la UART trabaja a 9 bits
+// y solo atiende lo que llega tras su dirección o la de difusión. Los
+// caracteres de dirección llevan el noveno bit a 1. En el bus solo se
+// transmite la respuesta a la petición que se está atendiendo: la telemetría,
+// los eventos y cualquier otro mensaje espontáneo se descartan. La dirección
+// es parte de config_t; DIRECCION_RS485 es solo la del arranque.
+#ifndef DIRECCION_RS485
+#define DIRECCION_RS485 0       // 0: consola punto a punto
+#endif
+#define DIRECCION_DIFUSION 0xFF // Todas las unidades ejecutan, ninguna responde
+
+uint32_t InicializarUART1(uint32_t baudios);
+uint32_t getBaudiosUART(void);
+void setDireccionUART(uint8_t direccion);
+uint8_t getDireccionUART(void);
+// writeUART(), putsUART() y getcUART() son el único productor de la cola de TX
+// y el único consumidor de la de RX: se llaman solo desde el programa principal.
+uint32_t writeUART(const void *buf, uint32_t len);
+uint32_t writeUARTPrioridad(const void *buf, uint32_t len, prioridad_tx_t prioridad);
 void putsUART(char s[]);
+void putsAlarmaUART(char s[]);
 char getcUART(void);
+void procesarUART(void);
+uint32_t getOcupacionTxUART(void);
+uint32_t getOcupacionRxUART(void);
+void setPoliticaTxUART(politica_tx_t politica, uint32_t timeout_ms);
+void getEstadisticasTxUART(estadisticas_tx_t *estadisticas);
+void getEstadisticasRxUART(estadisticas_rx_t *estadisticas);
+
+// Configuración del dispensador. Se cambia siempre entera: se valida todo y
+// se aplica de una vez o no se aplica nada. Horas negativas: sin programar.
+// Cada comida tiene una máscara de días de la semana (ver Calendario.h).
+// La dirección en el bus se aplica la última, con la respuesta ya enviada.
+typedef struct {
+    int peso;
+    int hora1, min1;
+    int hora2, min2;
+    int dias1, dias2;
+    int direccion;  // 0 punto a punto, 1..254 en el bus RS-485
+} config_t;
+
+void getConfiguracion(config_t *config);
+resultado_cmd_t setConfiguracion(const config_t *config);
 
+// Avisos por campo, para los programas de prueba que los usan
 int hayNuevoPeso(void);
 int getPesoUART(void);
 
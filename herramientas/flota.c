@@ -0,0 +1,408 @@
+/*
+ * flota: maneja N dispensadores a la vez desde Linux.
+ *
+ * Cada unidad es un puerto serie real (/dev/ttyUSB0...) o uno de los
+ * pseudoterminales de herramientas/simulador.c, que ejecuta en el PC los
+ * comandos y el protocolo del firmware:
+ *     simulador -n 4 > unidades &
+ *     flota -t 200 -s 10 $(cat unidades)
+ * Primero se configura cada unidad con los comandos de texto de Uart.c
+ * (una transacción Config con peso y horario, y el periodo de telemetría) y después se escucha durante un
+ * tiempo la telemetría y los eventos binarios de Protocolo.h. Al final se
+ * muestra, por unidad, la latencia de los comandos y el caudal recibido.
+ *
+ * Compilar:  cc -O2 -Wall -o flota herramientas/flota.c
+ * Uso:       flota [-b baudios] [-p kg] [-1 hhmm] [-2 hhmm] [-t ms] [-s seg]
+ *                  [-m ms] dispositivo...
+ */
+
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_UNIDADES 256
+#define MAX_LINEA 128
+#define MAX_TRAMA 160
+#define MAX_PASOS 8
+#define TIMEOUT_COMANDO_MS 2000
+
+// Del protocolo binario del firmware (Protocolo.h)
+#define MSG_RESPUESTA   0x80
+#define MSG_EVENTO      0x40
+#define MSG_TELEMETRIA  0x41
+#define TAM_TELEMETRIA  24
+
+typedef struct {
+    char comando[48];
+    const char *respuesta; // Prefijo de la línea que confirma; NULL si no hay
+} paso_t;
+
+typedef struct {
+    const char *ruta;
+    int fd;
+
+    // Provisión: un paso en vuelo cada vez
+    int paso;
+    uint64_t enviado_ms;
+
+    // Recepción
+    char linea[MAX_LINEA];
+    int long_linea;
+    uint8_t trama[MAX_TRAMA];
+    int long_trama;
+    int en_trama;
+
+    // Resultados
+    uint32_t comandos, errores, timeouts;
+    uint64_t latencia_total_ms, latencia_max_ms;
+    uint32_t telemetrias, eventos, errores_crc, perdidas_secuencia;
+    int secuencia_anterior;
+    uint64_t bytes_rx;
+    uint32_t peso, racion, dispensaciones;
+} unidad_t;
+
+static unidad_t unidades[MAX_UNIDADES];
+static int num_unidades = 0;
+static paso_t pasos[MAX_PASOS];
+static int num_pasos = 0;
+
+static uint64_t ahoraMs(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+static speed_t velocidadTermios(int baudios) {
+    switch (baudios) {
+        case 1200: return B1200;
+        case 2400: return B2400;
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        default: return 0;
+    }
+}
+
+static int abrirUnidad(unidad_t *u, speed_t velocidad) {
+    struct termios tio;
+
+    u->fd = open(u->ruta, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (u->fd < 0) {
+        fprintf(stderr, "%s: %s\n", u->ruta, strerror(errno));
+        return -1;
+    }
+    // En un pseudoterminal la velocidad no importa, pero el modo crudo sí
+    if (tcgetattr(u->fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, velocidad);
+        cfsetospeed(&tio, velocidad);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tcsetattr(u->fd, TCSANOW, &tio);
+        tcflush(u->fd, TCIOFLUSH);
+    }
+    u->paso = -1;
+    u->secuencia_anterior = -1;
+    return 0;
+}
+
+static void enviarPaso(unidad_t *u) {
+    char linea[64];
+    int n = snprintf(linea, sizeof(linea), "%s\r", pasos[u->paso].comando);
+
+    if (write(u->fd, linea, n) != n) {
+        u->errores++;
+    }
+    u->enviado_ms = ahoraMs();
+}
+
+// Cierra el paso en curso (confirmado o no) y lanza el siguiente.
+static void siguientePaso(unidad_t *u, int confirmado) {
+    if (u->paso >= 0) {
+        uint64_t latencia = ahoraMs() - u->enviado_ms;
+
+        u->comandos++;
+        if (confirmado) {
+            u->latencia_total_ms += latencia;
+            if (latencia > u->latencia_max_ms) {
+                u->latencia_max_ms = latencia;
+            }
+        }
+    }
+    // Los pasos sin respuesta se dan por hechos al enviarlos
+    while (++u->paso < num_pasos) {
+        enviarPaso(u);
+        if (pasos[u->paso].respuesta != NULL) {
+            return;
+        }
+        u->comandos++;
+    }
+}
+
+static uint16_t crc16(const uint8_t *datos, int n) {
+    uint16_t crc = 0xFFFF;
+    int i, bit;
+
+    for (i = 0; i < n; i++) {
+        crc ^= (uint16_t) datos[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static int decodificarCobs(const uint8_t *origen, int n, uint8_t *destino) {
+    int leido = 0, escrito = 0;
+
+    while (leido < n) {
+        uint8_t codigo = origen[leido++];
+        int i;
+
+        if (codigo == 0 || leido + codigo - 1 > n) {
+            return -1;
+        }
+        for (i = 1; i < codigo; i++) {
+            destino[escrito++] = origen[leido++];
+        }
+        if (codigo != 0xFF && leido < n) {
+            destino[escrito++] = 0;
+        }
+    }
+    return escrito;
+}
+
+static uint32_t leer16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t leer32(const uint8_t *p) {
+    return leer16(p) | (leer16(p + 2) << 16);
+}
+
+static void procesarTrama(unidad_t *u) {
+    uint8_t mensaje[MAX_TRAMA];
+    int n = decodificarCobs(u->trama, u->long_trama, mensaje);
+
+    if (n < 4 || crc16(mensaje, n - 2) != leer16(&mensaje[n - 2])) {
+        u->errores_crc++;
+        return;
+    }
+    n -= 2;
+    if (mensaje[0] == MSG_EVENTO) {
+        u->eventos++;
+    } else if (mensaje[0] == MSG_TELEMETRIA && n - 2 == TAM_TELEMETRIA) {
+        const uint8_t *r = &mensaje[2];
+
+        if (u->secuencia_anterior >= 0 &&
+            mensaje[1] != (uint8_t) (u->secuencia_anterior + 1)) {
+            u->perdidas_secuencia += (uint8_t) (mensaje[1] - u->secuencia_anterior - 1);
+        }
+        u->secuencia_anterior = mensaje[1];
+        u->telemetrias++;
+        u->peso = leer16(&r[4]);
+        u->racion = leer16(&r[6]);
+        u->dispensaciones = leer32(&r[12]);
+    }
+}
+
+static void procesarLinea(unidad_t *u) {
+    u->linea[u->long_linea] = '\0';
+    if (u->paso < 0 || u->paso >= num_pasos) {
+        return;
+    }
+    if (strncmp(u->linea, "ERR", 3) == 0) {
+        u->errores++;
+        siguientePaso(u, 0);
+    } else if (strncmp(u->linea, pasos[u->paso].respuesta,
+                       strlen(pasos[u->paso].respuesta)) == 0) {
+        siguientePaso(u, 1);
+    }
+}
+
+// Separa texto y tramas igual que procesarUART() en el firmware.
+static void recibir(unidad_t *u) {
+    uint8_t datos[256];
+    ssize_t n, i;
+
+    while ((n = read(u->fd, datos, sizeof(datos))) > 0) {
+        u->bytes_rx += n;
+        for (i = 0; i < n; i++) {
+            uint8_t c = datos[i];
+
+            if (c == 0) {
+                if (u->en_trama && u->long_trama > 0) {
+                    procesarTrama(u);
+                    u->en_trama = 0;
+                } else {
+                    u->en_trama = 1;
+                    u->long_trama = 0;
+                }
+            } else if (u->en_trama) {
+                if (u->long_trama < MAX_TRAMA) {
+                    u->trama[u->long_trama++] = c;
+                }
+            } else if (c == '\n' || c == '\r') {
+                if (u->long_linea > 0) {
+                    procesarLinea(u);
+                }
+                u->long_linea = 0;
+            } else if (u->long_linea < MAX_LINEA - 1) {
+                u->linea[u->long_linea++] = c;
+            }
+        }
+    }
+}
+
+static void anadirPaso(const char *respuesta, const char *formato, int valor) {
+    snprintf(pasos[num_pasos].comando, sizeof(pasos[0].comando), formato, valor);
+    pasos[num_pasos].respuesta = respuesta;
+    num_pasos++;
+}
+
+static void informe(uint64_t duracion_ms) {
+    int i;
+
+    printf("%-20s %5s %4s %4s %8s %8s %6s %6s %5s %5s %9s %5s %6s %5s\n",
+           "unidad", "cmds", "err", "t/o", "lat_med", "lat_max", "telem", "perd",
+           "evt", "crc", "B/s", "peso", "racion", "disp");
+    for (i = 0; i < num_unidades; i++) {
+        unidad_t *u = &unidades[i];
+        uint32_t confirmados = u->comandos - u->errores - u->timeouts;
+
+        printf("%-20s %5u %4u %4u %6llums %6llums %6u %6u %5u %5u %9llu %5u %6u %5u\n",
+               u->ruta, u->comandos, u->errores, u->timeouts,
+               confirmados ? (unsigned long long) (u->latencia_total_ms / confirmados) : 0ULL,
+               (unsigned long long) u->latencia_max_ms,
+               u->telemetrias, u->perdidas_secuencia, u->eventos, u->errores_crc,
+               (unsigned long long) (duracion_ms ? u->bytes_rx * 1000 / duracion_ms : 0),
+               u->peso, u->racion, u->dispensaciones);
+    }
+}
+
+static void uso(void) {
+    fprintf(stderr, "uso: flota [-b baudios] [-p kg] [-1 hhmm] [-2 hhmm] [-t ms] "
+                    "[-s seg] [-m ms] dispositivo...\n"
+                    "  -m ms  envia 'Hora' periodicamente para medir la latencia\n");
+    exit(2);
+}
+
+int main(int argc, char *argv[]) {
+    static struct pollfd fds[MAX_UNIDADES];
+    int baudios = 9600, peso = -1, comida1 = -1, comida2 = -1;
+    int telemetria = 1000, segundos = 10, sondeo_ms = 0;
+    uint64_t inicio, fin, ultimo_sondeo;
+    speed_t velocidad;
+    int opcion, i;
+
+    while ((opcion = getopt(argc, argv, "b:p:1:2:t:s:m:")) != -1) {
+        switch (opcion) {
+            case 'b': baudios = atoi(optarg); break;
+            case 'p': peso = atoi(optarg); break;
+            case '1': comida1 = atoi(optarg); break;
+            case '2': comida2 = atoi(optarg); break;
+            case 't': telemetria = atoi(optarg); break;
+            case 's': segundos = atoi(optarg); break;
+            case 'm': sondeo_ms = atoi(optarg); break;
+            default: uso();
+        }
+    }
+    velocidad = velocidadTermios(baudios);
+    if (optind >= argc || velocidad == 0) {
+        uso();
+    }
+
+    // Peso y horario van en una sola transacción 'Config'
+    if (peso > 0 || comida1 >= 0 || comida2 >= 0) {
+        char config[48] = "Config:";
+
+        if (peso > 0) {
+            snprintf(config + strlen(config), sizeof(config) - strlen(config), "P=%d;", peso);
+        }
+        if (comida1 >= 0) {
+            snprintf(config + strlen(config), sizeof(config) - strlen(config), "H1=%04d;", comida1);
+        }
+        if (comida2 >= 0) {
+            snprintf(config + strlen(config), sizeof(config) - strlen(config), "H2=%04d;", comida2);
+        }
+        config[strlen(config) - 1] = '\0';
+        anadirPaso("Config:", config, 0); // Sin '%': el valor no se usa
+    }
+    anadirPaso(NULL, "Telemetria:%d", telemetria);
+    anadirPaso("Hora actual", "Hora", 0); // También confirma que el resto llegó
+
+    for (i = optind; i < argc && num_unidades < MAX_UNIDADES; i++) {
+        unidad_t *u = &unidades[num_unidades];
+
+        u->ruta = argv[i];
+        if (abrirUnidad(u, velocidad) == 0) {
+            fds[num_unidades].fd = u->fd;
+            fds[num_unidades].events = POLLIN;
+            num_unidades++;
+        }
+    }
+    if (num_unidades == 0) {
+        return 1;
+    }
+
+    // Todas las unidades se configuran a la vez: cada una avanza por sus
+    // pasos a medida que llegan sus respuestas.
+    inicio = ahoraMs();
+    for (i = 0; i < num_unidades; i++) {
+        siguientePaso(&unidades[i], 0);
+    }
+    fin = inicio + (uint64_t) segundos * 1000;
+    ultimo_sondeo = inicio;
+
+    while (ahoraMs() < fin) {
+        uint64_t ahora;
+
+        if (poll(fds, num_unidades, 50) < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+        ahora = ahoraMs();
+        for (i = 0; i < num_unidades; i++) {
+            unidad_t *u = &unidades[i];
+
+            if (fds[i].revents & POLLIN) {
+                recibir(u);
+            }
+            if (u->paso >= 0 && u->paso < num_pasos &&
+                ahora - u->enviado_ms > TIMEOUT_COMANDO_MS) {
+                u->timeouts++;
+                siguientePaso(u, 0);
+            }
+        }
+        // Sondeo de latencia: se repite el último paso ('Hora')
+        if (sondeo_ms > 0 && ahora - ultimo_sondeo >= (uint64_t) sondeo_ms) {
+            ultimo_sondeo = ahora;
+            for (i = 0; i < num_unidades; i++) {
+                unidad_t *u = &unidades[i];
+
+                if (u->paso >= num_pasos) {
+                    u->paso = num_pasos - 1;
+                    enviarPaso(u);
+                }
+            }
+        }
+    }
+
+    informe(ahoraMs() - inicio);
+    for (i = 0; i < num_unidades; i++) {
+        close(unidades[i].fd);
+    }
+    return 0;
+}
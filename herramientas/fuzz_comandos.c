@@ -0,0 +1,282 @@
+/*
+ * fuzz_comandos: la recepción de la UART1 compilada en el PC y alimentada con
+ * bytes arbitrarios, desde la FIFO del hardware hasta los manejadores.
+ *
+ * Uart.c, Servo.c y los módulos con comandos se enlazan sin cambios sobre el
+ * hardware emulado de herramientas/pc. Cada byte entra en la FIFO de RX, lo
+ * saca InterrupcionUART1(), que publica EV_RX, y la tarea UART ejecuta
+ * procesarUART() como en main.c: el protocolo binario, el montaje de líneas y
+ * los manejadores reales, incluidos los de texto (Config, Dias Primera/Segunda,
+ * Ajustar Fecha) y las comprobaciones de setConfiguracion().
+ *
+ * El byte 0xFF introduce un suceso del hardware con los que le siguen:
+ *     0xFF 0xFF     el dato 0xFF
+ *     0xFF 'A' n    carácter de dirección n (noveno bit a 1)
+ *     0xFF 'F' n    n con error de trama; 0xFF 'P' n, con error de paridad
+ *     0xFF 'R'      empieza o acaba una ráfaga: la ISR no atiende la FIFO,
+ *                   que acaba desbordándose
+ *     0xFF 'L'      empieza o acaba un tramo en que la tarea UART no se
+ *                   despacha: se llena la cola de RX
+ *     0xFF 'T' n    pasan n * 10 ms
+ * Entre dos bytes pasa 1 ms, así que las entradas largas también pasan por el
+ * plazo entre bytes de las tramas. Aborta, para que el fuzzer lo vea, si en
+ * el bus RS-485 sale algo sin el driver del transceptor activado. Cada
+ * entrada empieza con la configuración inicial y la consola punto a punto.
+ *
+ * Con libFuzzer se usa el punto de entrada LLVMFuzzerTestOneInput(). Con
+ * -DBANCO se compila en su lugar un main() que mide el caudal con una mezcla
+ * de líneas válidas, erróneas y tramas binarias. Es el caudal en el PC: sirve
+ * para comparar versiones de la recepción, no como cifra del PIC32. Termina
+ * con error si alguna de esas líneas se rechaza por larga: entre ellas va
+ * LINEA_MAS_LARGA.
+ *
+ * Fuentes:   FUENTES="herramientas/pc/EmulacionPC.c Uart.c Servo.c Comandos.c
+ *                Protocolo.c Formato.c Cola.c Mascota.c Calendario.c
+ *                Telemetria.c Planificador.c Temporizadores.c"
+ * Compilar:  clang -g -O1 -fsanitize=fuzzer,address,undefined -fno-strict-aliasing \
+ *                -Iherramientas/pc -I. -o fuzz_comandos herramientas/fuzz_comandos.c $FUENTES
+ *            cc -std=c99 -O2 -Wall -fno-strict-aliasing -DBANCO -Iherramientas/pc -I. \
+ *                -o banco_comandos herramientas/fuzz_comandos.c $FUENTES
+ * Uso:       fuzz_comandos [opciones de libFuzzer] [corpus...]
+ *            banco_comandos [megabytes]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "EmulacionPC.h"
+#include "Comandos.h"
+#include "Protocolo.h"
+#include "Uart.h"
+#include "Mascota.h"
+#include "Servo.h"
+#include "Timer.h"
+#include "Calendario.h"
+#include "Telemetria.h"
+#include "Planificador.h"
+#include "Temporizadores.h"
+
+#define ESCAPE 0xFF
+
+static const char error_larga[] = "ERR linea demasiado larga";
+
+static uint32_t reloj_ms = 0;
+static uint64_t bytes_tx = 0;
+static uint32_t lineas_largas = 0;
+static unsigned coincidencia = 0;
+static int retener_rx = 0;
+static int retener_tarea = 0;
+static config_t config_inicial;
+static tarea_t tarea_uart;
+
+static void tareaUart(const evento_tarea_t *evento) {
+    (void) evento;
+    procesarUART();
+}
+
+// Lo que sale por U1TX. Se buscan los rechazos por línea larga.
+static void salida(const uint8_t *datos, uint32_t n) {
+    uint32_t i;
+
+    if (getDireccionUART() != 0 && !pcDriverRS485()) {
+        abort(); // En el bus se transmitiría con el transceptor apagado
+    }
+    bytes_tx += n;
+    for (i = 0; i < n; i++) {
+        if (datos[i] == (uint8_t) error_larga[coincidencia]) {
+            if (++coincidencia == sizeof(error_larga) - 1) {
+                lineas_largas++;
+                coincidencia = 0;
+            }
+        } else {
+            coincidencia = datos[i] == (uint8_t) error_larga[0];
+        }
+    }
+}
+
+static void inicializar(void) {
+    static int hecho = 0;
+
+    if (hecho) {
+        return;
+    }
+    hecho = 1;
+    pcFijarSalida(salida);
+    InicializarTimer();
+    InicializarTemporizadores();
+    InicializarPlanificador();
+    InicializarUART1(115200);
+    InicializarMascota();
+    InicializarServo();
+    InicializarCalendario();
+    InicializarTelemetria();
+    crearTarea(&tarea_uart, "UART", 3, 20, EVENTO(EV_RX), tareaUart);
+    getConfiguracion(&config_inicial);
+}
+
+// Lo que hace ejecutarPlanificador() entre dos reposos
+static void despachar(void) {
+    procesarTemporizadores(getTiempoAbsoluto());
+    if (!retener_tarea) {
+        while (despacharTarea())
+            ;
+    }
+}
+
+static void pasarTiempo(uint32_t ms) {
+    reloj_ms += ms;
+    pcFijarTiempo(reloj_ms);
+}
+
+static void recibir(const uint8_t *datos, size_t n) {
+    size_t i = 0;
+
+    while (i < n) {
+        uint8_t c = datos[i++];
+
+        pasarTiempo(1);
+        if (c != ESCAPE || i == n) {
+            pcRecibirUART(c, 0);
+        } else {
+            uint8_t suceso = datos[i++];
+            uint8_t arg = i < n ? datos[i] : 0;
+
+            switch (suceso) {
+                case 'A':
+                    pcRecibirUART(BIT_DIRECCION_PC | arg, 0);
+                    i++;
+                    break;
+                case 'F':
+                    pcRecibirUART(arg, ERROR_PC_TRAMA);
+                    i++;
+                    break;
+                case 'P':
+                    pcRecibirUART(arg, ERROR_PC_PARIDAD);
+                    i++;
+                    break;
+                case 'R':
+                    retener_rx = !retener_rx;
+                    pcRetenerRecepcion(retener_rx);
+                    break;
+                case 'L':
+                    retener_tarea = !retener_tarea;
+                    break;
+                case 'T':
+                    pasarTiempo(10 * arg);
+                    i++;
+                    break;
+                default:
+                    pcRecibirUART(suceso, 0); // Incluido 0xFF 0xFF
+                    break;
+            }
+        }
+        despachar();
+    }
+}
+
+#ifndef BANCO
+
+int LLVMFuzzerTestOneInput(const uint8_t *datos, size_t n) {
+    inicializar();
+    retener_rx = 0;
+    retener_tarea = 0;
+    pcRetenerRecepcion(0);
+    despachar();
+    setConfiguracion(&config_inicial);
+    setPoliticaTxUART(TX_DESCARTAR_NUEVO, 100);
+    setPeriodoTelemetria(0);
+    reiniciarLinea();
+    protocoloReiniciar();
+    recibir(datos, n);
+    return 0;
+}
+
+#else
+
+// Config con A=254 pasa la unidad al bus: la línea siguiente la selecciona.
+static const char *const lineas[] = {
+    "Peso:25\r\n",
+    "Primera Comida:0830\r\n",
+    LINEA_MAS_LARGA "\r\n",
+    "\xFF" "A\xFE" "Mostrar Config\r\n",
+    "Peso:500\r\n",
+    "Comando que no existe\r\n",
+    "Dispensar:abc\r\n",
+};
+
+// Trama MSG_PESO completa, con sus dos delimitadores
+static size_t trama(uint8_t *salida, uint8_t secuencia) {
+    uint8_t mensaje[2 + 2 + 2];
+    uint8_t *p = mensaje;
+    size_t n;
+
+    *p++ = MSG_PESO;
+    *p++ = secuencia;
+    p = poner16(p, 30);
+    poner16(p, calcularCrc16(mensaje, 4));
+    salida[0] = 0;
+    n = codificarCobs(mensaje, sizeof(mensaje), &salida[1]);
+    salida[n + 1] = 0;
+    return n + 2;
+}
+
+static double segundos(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 16;
+    size_t tam = 1 << 16, total = 0, n = 0, vueltas, v;
+    uint8_t *bloque = malloc(tam + 64);
+    unsigned i = 0, lineas_bloque = 0;
+    double inicio, duracion;
+
+    if (bloque == NULL || megabytes == 0) {
+        fprintf(stderr, "uso: %s [megabytes]\n", argv[0]);
+        return 1;
+    }
+    inicializar();
+    // Siete líneas y una trama, en bucle, hasta llenar el bloque
+    while (n < tam) {
+        if (i % 8 == 7) {
+            n += trama(&bloque[n], (uint8_t) i);
+        } else {
+            size_t l = strlen(lineas[i % 8]);
+
+            memcpy(&bloque[n], lineas[i % 8], l);
+            n += l;
+            lineas_bloque++;
+        }
+        i++;
+    }
+    vueltas = megabytes * 1024 * 1024 / n;
+
+    inicio = segundos();
+    for (v = 0; v < vueltas; v++) {
+        recibir(bloque, n);
+        total += n;
+    }
+    duracion = segundos() - inicio;
+
+    printf("%zu bytes en %.3f s: %.1f MB/s, %.0f lineas/s, %.1f ns/byte\n",
+           total, duracion, total / duracion / 1e6, lineas_bloque * vueltas / duracion,
+           duracion * 1e9 / total);
+    printf("respuestas %llu bytes, x%.0f sobre 115200 baudios\n",
+           (unsigned long long) bytes_tx, total / duracion / 11520.0);
+    free(bloque);
+    if (lineas_largas != 0) {
+        fprintf(stderr, "%u lineas rechazadas por largas (MAX_LINEA %d)\n",
+                lineas_largas, MAX_LINEA);
+        return 1;
+    }
+    return 0;
+}
+
+#endif
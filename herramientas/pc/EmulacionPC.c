@@ -0,0 +1,357 @@
+#define _POSIX_C_SOURCE 199309L
+#include <xc.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include "EmulacionPC.h"
+#include "Pic32Ini.h"
+#include "Timer.h"
+#include "Perfil.h"
+#include "SeccionCritica.h"
+#include "Comandos.h"
+#include "Formato.h"
+#include "Uart.h"
+
+#define TAM_FIFO_RX 8 // Potencia de 2
+#define PIN_DE_RS485 2
+#define IPL_PERIFERICOS IPL_UART // La UART1 y su DMA comparten prioridad
+
+registro_pc_t U1MODE_pc, U1BRG_pc, U1TXREG_pc;
+registro_pc_t U1STA_pc = {_U1STA_TRMT_MASK}; // El DMA lo deja todo enviado al momento
+registro_pc_t IFS1_pc, IEC1_pc, IPC8_pc, IPC10_pc;
+registro_pc_t DMACON_pc, DCH0CON_pc, DCH0ECON_pc, DCH0INT_pc;
+registro_pc_t DCH0SSIZ_pc, DCH0DSIZ_pc, DCH0CSIZ_pc;
+registro_pc_t ANSELA_pc, ANSELB_pc, TRISB_pc, LATB_pc, SYSKEY_pc, U1RXR_pc;
+registro_pc_t RPB7R_pc, RPB14R_pc;
+registro_pc_t OC3CON_pc, OC3R_pc, OC3RS_pc, T2CON_pc, TMR2_pc, PR2_pc;
+volatile uintptr_t DCH0SSA_pc, DCH0DSA_pc;
+
+// Las ISR de Uart.c
+void InterrupcionUART1(void);
+void InterrupcionDMA0(void);
+
+// Una escritura en RegSET o RegCLR se aplica en el siguiente acceso a
+// cualquier registro: pcRegistro() devuelve dónde escribir la máscara.
+static registro_pc_t *pendiente = NULL;
+static acceso_pc_t acceso_pendiente;
+static uint32_t mascara_pendiente;
+
+static struct {
+    uint16_t dato;
+    uint8_t error;
+} fifo_rx[TAM_FIFO_RX];
+static uint32_t cabeza_rx = 0, cola_rx = 0;
+
+static int retener_rx = 0;
+static int en_isr = 0;
+static uint32_t ipl = 0;
+static void (*salida)(const uint8_t *datos, uint32_t n) = NULL;
+static void (*esperar)(uint32_t instante) = NULL;
+
+// Reloj de Timer.c
+static uint32_t milis = 0;
+static uint32_t milis_dormido = 0;
+static uint32_t hora_ms = 0;    // Hora del día al fijarla, en ms
+static uint32_t milis_hora = 0; // milis cuando se fijó
+
+static void comandoHora(int32_t arg);
+
+// Las mismas que Timer.c
+static const comando_t comandos_timer[] = {
+    {"Hora", ARG_NINGUNO, 0, 0, comandoHora, "Muestra la hora actual", NULL},
+};
+
+static void aplicarPendiente(void) {
+    if (pendiente == NULL) {
+        return;
+    }
+    if (acceso_pendiente == ACCESO_PC_SET) {
+        pendiente->valor |= mascara_pendiente;
+    } else {
+        pendiente->valor &= ~mascara_pendiente;
+    }
+    pendiente = NULL;
+}
+
+// Cabeza de la FIFO en U1STA: URXDA, y FERR y PERR del carácter en cabeza.
+static void actualizarEstadoRx(void) {
+    uint32_t sta = U1STA_pc.valor & ~(_U1STA_URXDA_MASK | _U1STA_FERR_MASK | _U1STA_PERR_MASK);
+
+    if (cola_rx != cabeza_rx) {
+        uint8_t error = fifo_rx[cola_rx & (TAM_FIFO_RX - 1)].error;
+
+        sta |= _U1STA_URXDA_MASK;
+        if (error & ERROR_PC_TRAMA) {
+            sta |= _U1STA_FERR_MASK;
+        }
+        if (error & ERROR_PC_PARIDAD) {
+            sta |= _U1STA_PERR_MASK;
+        }
+    }
+    U1STA_pc.valor = sta;
+}
+
+// La FIFO de TX emulada siempre tiene sitio, así que la petición de la UART
+// está siempre activa: un canal que arranca con ella no espera al CFORCE.
+// Así avanzan también los bucles que solo miran variables de Uart.c mientras
+// el DMA termina, como esperarFinTx().
+static int canalArmado(void) {
+    uint32_t econ = DCH0ECON_pc.valor;
+
+    if (!(DMACON_pc.valor & _DMACON_ON_MASK) || !(DCH0CON_pc.valor & _DCH0CON_CHEN_MASK)) {
+        return 0;
+    }
+    return (econ & _DCH0ECON_CFORCE_MASK) ||
+           ((econ & _DCH0ECON_SIRQEN_MASK) &&
+            ((econ & _DCH0ECON_CHSIRQ_MASK) >> _DCH0ECON_CHSIRQ_POSITION) == _UART1_TX_IRQ);
+}
+
+// El canal 0 envía el tramo entero de una vez y avisa con CHBCIF.
+static int avanzarDMA(void) {
+    uint32_t n = DCH0SSIZ_pc.valor;
+
+    if (!canalArmado()) {
+        return 0;
+    }
+    if (salida != NULL && n != 0) {
+        salida((const uint8_t *) DCH0SSA_pc, n);
+    }
+    DCH0CON_pc.valor &= ~_DCH0CON_CHEN_MASK;
+    DCH0ECON_pc.valor &= ~_DCH0ECON_CFORCE_MASK;
+    DCH0INT_pc.valor |= _DCH0INT_CHBCIF_MASK;
+    IFS1_pc.valor |= _IFS1_DMA0IF_MASK | _IFS1_U1TXIF_MASK; // Y la FIFO de TX vacía
+    return 1;
+}
+
+static void ejecutarISR(void (*isr)(void)) {
+    uint32_t anterior = ipl;
+
+    en_isr = 1;
+    ipl = IPL_PERIFERICOS;
+    isr();
+    aplicarPendiente();
+    ipl = anterior;
+    en_isr = 0;
+}
+
+// Una vuelta del hardware: el DMA y, si el IPL lo deja, una interrupción.
+static int avanzar(void) {
+    uint32_t ifs = IFS1_pc.valor, iec = IEC1_pc.valor;
+    uint32_t rx = _IFS1_U1RXIF_MASK | _IFS1_U1EIF_MASK;
+
+    if (avanzarDMA()) {
+        return 1;
+    }
+    if (ipl >= IPL_PERIFERICOS) {
+        return 0;
+    }
+    if (ifs & iec & _IFS1_DMA0IF_MASK) {
+        ejecutarISR(InterrupcionDMA0);
+        return 1;
+    }
+    if ((!retener_rx && (ifs & iec & rx)) || (ifs & iec & _IFS1_U1TXIF_MASK)) {
+        ejecutarISR(InterrupcionUART1);
+        return 1;
+    }
+    return 0;
+}
+
+void pcAtender(void) {
+    aplicarPendiente();
+    if (en_isr) {
+        return;
+    }
+    while (avanzar())
+        ;
+}
+
+volatile void *pcRegistro(registro_pc_t *r, acceso_pc_t acceso) {
+    pcAtender();
+    if (acceso != ACCESO_PC_VALOR) {
+        pendiente = r;
+        acceso_pendiente = acceso;
+        mascara_pendiente = 0;
+        return &mascara_pendiente;
+    }
+    return &r->valor;
+}
+
+uint32_t pcLeerU1RXREG(void) {
+    uint32_t dato = 0;
+
+    aplicarPendiente();
+    if (cola_rx != cabeza_rx) {
+        dato = fifo_rx[cola_rx & (TAM_FIFO_RX - 1)].dato;
+        cola_rx++;
+    }
+    actualizarEstadoRx();
+    return dato;
+}
+
+// Lo que el hardware no deja pasar no llega a la FIFO: el autobaud se come
+// el carácter que mide, ADDEN los datos y OERR todo hasta que se borra.
+void pcRecibirUART(uint32_t dato, int error) {
+    uint32_t modo, sta;
+
+    aplicarPendiente();
+    modo = U1MODE_pc.valor;
+    sta = U1STA_pc.valor;
+    if (!(modo & _U1MODE_ON_MASK) || !(sta & _U1STA_URXEN_MASK)) {
+        return;
+    }
+    if (modo & _U1MODE_ABAUD_MASK) {
+        U1MODE_pc.valor = modo & ~_U1MODE_ABAUD_MASK;
+        return;
+    }
+    if ((modo & _U1MODE_PDSEL_MASK) == _U1MODE_PDSEL_MASK) {
+        if ((sta & _U1STA_ADDEN_MASK) && !(dato & BIT_DIRECCION_PC)) {
+            return;
+        }
+        dato &= 0x1FF;
+    } else {
+        dato &= 0xFF;
+    }
+    if (sta & _U1STA_OERR_MASK) {
+        return;
+    }
+    if (cabeza_rx - cola_rx == TAM_FIFO_RX) {
+        U1STA_pc.valor = sta | _U1STA_OERR_MASK;
+        IFS1_pc.valor |= _IFS1_U1EIF_MASK;
+        pcAtender();
+        return;
+    }
+    fifo_rx[cabeza_rx & (TAM_FIFO_RX - 1)].dato = dato;
+    fifo_rx[cabeza_rx & (TAM_FIFO_RX - 1)].error = error;
+    cabeza_rx++;
+    actualizarEstadoRx();
+    IFS1_pc.valor |= _IFS1_U1RXIF_MASK | (error ? _IFS1_U1EIF_MASK : 0);
+    pcAtender();
+}
+
+void pcRetenerRecepcion(int retener) {
+    retener_rx = retener;
+    pcAtender();
+}
+
+void pcFijarSalida(void (*funcion)(const uint8_t *datos, uint32_t n)) {
+    salida = funcion;
+}
+
+int pcDriverRS485(void) {
+    aplicarPendiente();
+    return (LATB_pc.valor >> PIN_DE_RS485) & 1;
+}
+
+void pcFijarTiempo(uint32_t ms) {
+    milis = ms;
+    pcAtender();
+}
+
+void pcFijarEspera(void (*funcion)(uint32_t instante)) {
+    esperar = funcion;
+}
+
+// Pic32Ini.c
+
+uint32_t getFrecuenciaPeriferico(void) {
+    return PBCLK;
+}
+
+// SeccionCritica.c: el IPL es el del programa emulado. Al bajarlo se
+// atiende lo que estuviera esperando.
+
+uint32_t entrarSeccionCritica(uint32_t techo) {
+    uint32_t estado = ipl;
+
+    if (techo > ipl) {
+        ipl = techo;
+    }
+    return estado;
+}
+
+void salirSeccionCritica(uint32_t estado) {
+    ipl = estado;
+    pcAtender();
+}
+
+// Perfil.c: Count a SYSCLK/2 a partir del reloj del PC; las zonas no se
+// acumulan.
+
+uint32_t getCiclos(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t) ((uint64_t) t.tv_sec * CICLOS_POR_US * 1000000 + t.tv_nsec / (1000 / CICLOS_POR_US));
+}
+
+void acumularPerfil(zona_perfil_t zona, uint32_t ciclos) {
+    (void) zona;
+    (void) ciclos;
+}
+
+// Timer.c
+
+void InicializarTimer(void) {
+    registrarComandos(comandos_timer, sizeof(comandos_timer) / sizeof(comandos_timer[0]));
+}
+
+// Leer la hora es, como en el PIC32, un momento en el que pueden llegar
+// interrupciones; los bucles que esperan al DMA avanzan así.
+uint32_t getTiempoAbsoluto(void) {
+    pcAtender();
+    return milis;
+}
+
+uint64_t getTiempoAbsoluto64(void) {
+    return getTiempoAbsoluto();
+}
+
+void getInstante(instante_t *instante) {
+    uint32_t del_dia = (hora_ms + getTiempoAbsoluto() - milis_hora) % (24 * 3600 * 1000u);
+
+    instante->h = del_dia / 3600000;
+    instante->m = del_dia / 60000 % 60;
+    instante->s = del_dia / 1000 % 60;
+    instante->ms = del_dia % 1000;
+    instante->milis = milis;
+}
+
+void setHoraActual(int hora, int minuto, int segundo) {
+    hora_ms = ((hora * 60 + minuto) * 60 + segundo) * 1000u;
+    milis_hora = milis;
+}
+
+void sincronizarHora(int hora, int minuto, int segundo) {
+    setHoraActual(hora, minuto, segundo);
+}
+
+void avisarTrabajo(void) {
+}
+
+void dormirHasta(uint32_t instante, uint32_t estado) {
+    uint32_t inicio = milis;
+
+    salirSeccionCritica(estado);
+    if (esperar != NULL) {
+        esperar(instante);
+    } else if ((int32_t) (instante - milis) > 0) {
+        pcFijarTiempo(instante);
+    }
+    milis_dormido += milis - inicio;
+}
+
+static void comandoHora(int32_t arg) {
+    char mensaje[64];
+    char *p;
+    instante_t ahora;
+
+    getInstante(&ahora);
+    p = fmtCadena(mensaje, "Hora actual: ");
+    p = fmtHoraSeg(p, ahora.h, ahora.m, ahora.s);
+    p = fmtCadena(p, ", encendido ");
+    p = fmtSinSigno(p, getTiempoAbsoluto64() / 1000);
+    p = fmtCadena(p, " s, dormido ");
+    p = fmtSinSigno(p, milis_dormido / 1000);
+    p = fmtCadena(p, " s\n\r");
+    writeUART(mensaje, p - mensaje);
+}
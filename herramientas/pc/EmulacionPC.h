@@ -0,0 +1,60 @@
+#ifndef EMULACIONPC_H
+#define EMULACIONPC_H
+
+#include <stdint.h>
+
+// Hardware del PIC32 emulado en el PC, lo justo para ejecutar sin cambios
+// Uart.c, Servo.c y los módulos que no tocan registros (Comandos.c,
+// Protocolo.c, Planificador.c...). Con el xc.h de este directorio se emulan:
+//
+//  - La UART1: FIFO de recepción con sus errores de trama y paridad, el
+//    desbordamiento (OERR), el modo de 9 bits con ADDEN y el autobaud, que se
+//    come el siguiente carácter.
+//  - El canal 0 de DMA, que envía cada tramo de golpe a la función de salida
+//    en cuanto se habilita: la FIFO de TX siempre tiene sitio.
+//  - Las interrupciones de la UART1 y del DMA, que se atienden al tocar
+//    cualquier registro, al leer la hora o al bajar el IPL, si el IPL de
+//    entrarSeccionCritica() lo permite. Nunca se anidan.
+//
+// También sustituye a Timer.c (hora en RAM, "Hora", dormirHasta()), Perfil.c,
+// SeccionCritica.c y Pic32Ini.c. El tiempo no corre solo: lo fija el programa
+// con pcFijarTiempo(), y dormirHasta() llama a la función de pcFijarEspera().
+
+typedef struct {
+    volatile uint32_t valor;
+} registro_pc_t;
+
+typedef enum {
+    ACCESO_PC_VALOR,
+    ACCESO_PC_SET,   // Escritura en RegSET
+    ACCESO_PC_CLR    // Escritura en RegCLR
+} acceso_pc_t;
+
+// Errores de un carácter recibido
+#define ERROR_PC_TRAMA   1
+#define ERROR_PC_PARIDAD 2
+
+#define BIT_DIRECCION_PC 0x100 // Noveno bit: carácter de dirección
+
+// Los usa xc.h
+volatile void *pcRegistro(registro_pc_t *r, acceso_pc_t acceso);
+uint32_t pcLeerU1RXREG(void);
+
+// Llega un carácter por la línea de RX de la UART1
+void pcRecibirUART(uint32_t dato, int error);
+// Con retener != 0 no se atiende la interrupción de RX: la FIFO se llena y
+// se desborda, como si la ISR llegase tarde
+void pcRetenerRecepcion(int retener);
+// Atiende el DMA y las interrupciones pendientes
+void pcAtender(void);
+// Recibe cada tramo que sale por U1TX
+void pcFijarSalida(void (*salida)(const uint8_t *datos, uint32_t n));
+// Estado del pin DE del transceptor RS-485
+int pcDriverRS485(void);
+
+void pcFijarTiempo(uint32_t ms);
+// esperar(instante) vuelve como mucho en el instante, en ms de
+// getTiempoAbsoluto(). Por defecto el tiempo salta al instante.
+void pcFijarEspera(void (*esperar)(uint32_t instante));
+
+#endif
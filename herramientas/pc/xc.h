@@ -0,0 +1,158 @@
+#ifndef XC_PC_H
+#define XC_PC_H
+
+// <xc.h> para compilar en el PC, sin cambios, los módulos que tocan la UART1,
+// su canal de DMA y el servo (Uart.c y Servo.c). Cada registro es un
+// registro_pc_t de EmulacionPC.c y todo acceso pasa por pcRegistro(), que
+// hace avanzar el hardware emulado (ver EmulacionPC.h). Solo están los
+// registros y los campos que usan esos módulos; las posiciones de los bits
+// son las del PIC32MX.
+
+#include <stdint.h>
+#include "EmulacionPC.h"
+
+#define SFR_PC(r)      (*(volatile uint32_t *) pcRegistro(&r##_pc, ACCESO_PC_VALOR))
+#define SFR_BITS_PC(r) (*(volatile __##r##bits_t *) pcRegistro(&r##_pc, ACCESO_PC_VALOR))
+#define SFR_SET_PC(r)  (*(volatile uint32_t *) pcRegistro(&r##_pc, ACCESO_PC_SET))
+#define SFR_CLR_PC(r)  (*(volatile uint32_t *) pcRegistro(&r##_pc, ACCESO_PC_CLR))
+
+typedef struct {
+    unsigned STSEL:1, PDSEL:2, BRGH:1, RXINV:1, ABAUD:1, LPBACK:1, WAKE:1;
+    unsigned UEN:2, :1, RTSMD:1, IREN:1, SIDL:1, :1, ON:1;
+} __U1MODEbits_t;
+
+typedef struct {
+    unsigned URXDA:1, OERR:1, FERR:1, PERR:1, RIDLE:1, ADDEN:1, URXISEL:2;
+    unsigned TRMT:1, UTXBF:1, UTXEN:1, UTXBRK:1, URXEN:1, UTXINV:1, UTXISEL:2;
+    unsigned ADDR:8, ADM_EN:1;
+} __U1STAbits_t;
+
+typedef struct {
+    unsigned :7, U1EIF:1, U1RXIF:1, U1TXIF:1, :6, DMA0IF:1;
+} __IFS1bits_t;
+
+typedef struct {
+    unsigned :7, U1EIE:1, U1RXIE:1, U1TXIE:1, :6, DMA0IE:1;
+} __IEC1bits_t;
+
+typedef struct {
+    unsigned :8, U1IS:2, U1IP:3;
+} __IPC8bits_t;
+
+typedef struct {
+    unsigned DMA0IS:2, DMA0IP:3;
+} __IPC10bits_t;
+
+typedef struct {
+    unsigned :15, ON:1;
+} __DMACONbits_t;
+
+typedef struct {
+    unsigned CHPRI:2, CHEDET:1, :1, CHAEN:1, CHCHN:1, CHAED:1, CHEN:1;
+} __DCH0CONbits_t;
+
+typedef struct {
+    unsigned :3, AIRQEN:1, SIRQEN:1, PATEN:1, CABORT:1, CFORCE:1, CHSIRQ:8;
+} __DCH0ECONbits_t;
+
+typedef struct {
+    unsigned CHERIF:1, CHTAIF:1, CHCCIF:1, CHBCIF:1, :12;
+    unsigned CHERIE:1, CHTAIE:1, CHCCIE:1, CHBCIE:1;
+} __DCH0INTbits_t;
+
+extern registro_pc_t U1MODE_pc, U1STA_pc, U1BRG_pc, U1TXREG_pc;
+extern registro_pc_t IFS1_pc, IEC1_pc, IPC8_pc, IPC10_pc;
+extern registro_pc_t DMACON_pc, DCH0CON_pc, DCH0ECON_pc, DCH0INT_pc;
+extern registro_pc_t DCH0SSIZ_pc, DCH0DSIZ_pc, DCH0CSIZ_pc;
+extern registro_pc_t ANSELA_pc, ANSELB_pc, TRISB_pc, LATB_pc, SYSKEY_pc, U1RXR_pc;
+extern registro_pc_t RPB7R_pc, RPB14R_pc;
+extern registro_pc_t OC3CON_pc, OC3R_pc, OC3RS_pc, T2CON_pc, TMR2_pc, PR2_pc;
+
+// Las direcciones físicas no caben en 32 bits en el PC
+extern volatile uintptr_t DCH0SSA_pc, DCH0DSA_pc;
+#define KVA_TO_PA(v) ((uintptr_t) (v))
+
+#define U1MODE      SFR_PC(U1MODE)
+#define U1MODEbits  SFR_BITS_PC(U1MODE)
+#define U1STA       SFR_PC(U1STA)
+#define U1STAbits   SFR_BITS_PC(U1STA)
+#define U1STASET    SFR_SET_PC(U1STA)
+#define U1STACLR    SFR_CLR_PC(U1STA)
+#define U1BRG       SFR_PC(U1BRG)
+#define U1RXREG     pcLeerU1RXREG()
+#define U1TXREG     (U1TXREG_pc.valor)
+#define IFS1bits    SFR_BITS_PC(IFS1)
+#define IFS1CLR     SFR_CLR_PC(IFS1)
+#define IEC1bits    SFR_BITS_PC(IEC1)
+#define IEC1SET     SFR_SET_PC(IEC1)
+#define IEC1CLR     SFR_CLR_PC(IEC1)
+#define IPC8bits    SFR_BITS_PC(IPC8)
+#define IPC10bits   SFR_BITS_PC(IPC10)
+#define DMACONbits  SFR_BITS_PC(DMACON)
+#define DCH0CON     SFR_PC(DCH0CON)
+#define DCH0CONbits SFR_BITS_PC(DCH0CON)
+#define DCH0ECON    SFR_PC(DCH0ECON)
+#define DCH0ECONbits SFR_BITS_PC(DCH0ECON)
+#define DCH0INT     SFR_PC(DCH0INT)
+#define DCH0INTbits SFR_BITS_PC(DCH0INT)
+#define DCH0INTCLR  SFR_CLR_PC(DCH0INT)
+#define DCH0SSA     DCH0SSA_pc
+#define DCH0DSA     DCH0DSA_pc
+#define DCH0SSIZ    SFR_PC(DCH0SSIZ)
+#define DCH0DSIZ    SFR_PC(DCH0DSIZ)
+#define DCH0CSIZ    SFR_PC(DCH0CSIZ)
+#define ANSELA      SFR_PC(ANSELA)
+#define ANSELB      SFR_PC(ANSELB)
+#define TRISB       SFR_PC(TRISB)
+#define LATB        SFR_PC(LATB)
+#define LATBSET     SFR_SET_PC(LATB)
+#define LATBCLR     SFR_CLR_PC(LATB)
+#define SYSKEY      SFR_PC(SYSKEY)
+#define U1RXR       SFR_PC(U1RXR)
+#define RPB7R       SFR_PC(RPB7R)
+#define RPB14R      SFR_PC(RPB14R)
+#define OC3CON      SFR_PC(OC3CON)
+#define OC3R        SFR_PC(OC3R)
+#define OC3RS       SFR_PC(OC3RS)
+#define T2CON       SFR_PC(T2CON)
+#define TMR2        SFR_PC(TMR2)
+#define PR2         SFR_PC(PR2)
+
+#define _U1MODE_PDSEL_MASK      0x00000006
+#define _U1MODE_ABAUD_MASK      0x00000020
+#define _U1MODE_ON_MASK         0x00008000
+#define _U1STA_URXDA_MASK       0x00000001
+#define _U1STA_OERR_MASK        0x00000002
+#define _U1STA_FERR_MASK        0x00000004
+#define _U1STA_PERR_MASK        0x00000008
+#define _U1STA_ADDEN_MASK       0x00000020
+#define _U1STA_TRMT_MASK        0x00000100
+#define _U1STA_URXEN_MASK       0x00001000
+#define _U1STA_UTXISEL_POSITION 14
+#define _U1STA_UTXISEL_MASK     0x0000C000
+#define _IFS1_U1EIF_MASK        0x00000080
+#define _IFS1_U1RXIF_MASK       0x00000100
+#define _IFS1_U1TXIF_MASK       0x00000200
+#define _IFS1_DMA0IF_MASK       0x00010000
+#define _IEC1_U1EIE_MASK        0x00000080
+#define _IEC1_U1RXIE_MASK       0x00000100
+#define _IEC1_U1TXIE_MASK       0x00000200
+#define _IEC1_DMA0IE_MASK       0x00010000
+#define _DMACON_ON_MASK         0x00008000
+#define _DCH0CON_CHEN_MASK      0x00000080
+#define _DCH0ECON_SIRQEN_MASK   0x00000010
+#define _DCH0ECON_CFORCE_MASK   0x00000080
+#define _DCH0ECON_CHSIRQ_POSITION 8
+#define _DCH0ECON_CHSIRQ_MASK   0x0000FF00
+#define _DCH0INT_CHBCIF_MASK    0x00000008
+
+#define _UART_1_VECTOR 32
+#define _DMA_0_VECTOR  36
+#define _UART1_TX_IRQ  41
+
+// Los atributos de las ISR del XC32 no existen en el PC
+#define vector(n) used
+#define interrupt(ipl) used
+#define nomips16 used
+
+#endif
@@ -0,0 +1,283 @@
+/*
+ * simulador: dispensadores sin placa, detrás de un pseudoterminal, para
+ * probar flota y cualquier otro cliente del puerto serie.
+ *
+ * Cada unidad es un proceso con el mismo Uart.c, Comandos.c, Protocolo.c y
+ * módulos de comandos que el firmware, sobre el hardware emulado de
+ * herramientas/pc, y con el planificador real: lo que llega por el
+ * pseudoterminal entra por la FIFO de RX y la ISR, y las respuestas salen por
+ * el DMA. Una tarea de control hace lo que la de main.c con la configuración,
+ * la telemetría y las dispensaciones, así que responden Config, Telemetria,
+ * Hora, Dispensar y el resto de comandos de texto y tramas binarias.
+ *
+ * No hay pantalla, sensor, buzzer ni registro por la UART2, las comidas no se
+ * sirven solas y la telemetría da la próxima comida sin mirar los días. La
+ * velocidad del pseudoterminal no cuenta: los bytes llegan tan deprisa como
+ * se escriben.
+ *
+ * Fuentes:   las FUENTES de fuzz_comandos.c
+ * Compilar:  cc -std=c99 -O2 -Wall -fno-strict-aliasing -Iherramientas/pc -I. \
+ *                -o simulador herramientas/simulador.c $FUENTES
+ * Uso:       simulador [-n unidades]
+ *            Escribe la ruta del pseudoterminal de cada unidad, para dársela
+ *            a flota, y sigue hasta que se interrumpe.
+ */
+
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "EmulacionPC.h"
+#include "Comandos.h"
+#include "Protocolo.h"
+#include "Uart.h"
+#include "Mascota.h"
+#include "Servo.h"
+#include "Timer.h"
+#include "Formato.h"
+#include "Calendario.h"
+#include "Telemetria.h"
+#include "Planificador.h"
+#include "Temporizadores.h"
+
+#define MAX_UNIDADES 64
+#define BYTES_POR_VUELTA 8 // Lo que cabe en la FIFO de RX
+#define ESTADO_REPOSO 4    // EST_PERRITO de main.c
+
+static int fd_maestro = -1;
+static uint64_t inicio_ms;
+static config_t config;
+
+static tarea_t tarea_uart;
+static tarea_t tarea_control;
+
+static uint64_t ahoraMs(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+static uint32_t milisUnidad(void) {
+    return (uint32_t) (ahoraMs() - inicio_ms);
+}
+
+// Lo que sale por U1TX va al pseudoterminal
+static void salida(const uint8_t *datos, uint32_t n) {
+    while (n > 0) {
+        ssize_t escritos = write(fd_maestro, datos, n);
+
+        if (escritos < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            return; // Nadie al otro lado
+        }
+        datos += escritos;
+        n -= escritos;
+    }
+}
+
+// dormirHasta(): se espera al instante o a que lleguen bytes, y el tiempo
+// emulado sigue al reloj del PC. Los bytes entran de FIFO en FIFO para que la
+// tarea UART los vaya sacando, como con la línea serie.
+static void esperar(uint32_t instante) {
+    int32_t espera = (int32_t) (instante - milisUnidad());
+    struct pollfd pfd = {fd_maestro, POLLIN, 0};
+    uint8_t bytes[BYTES_POR_VUELTA];
+    ssize_t i, n = 0;
+
+    if (espera > 0 && poll(&pfd, 1, espera) > 0 && (pfd.revents & POLLIN)) {
+        n = read(fd_maestro, bytes, sizeof(bytes));
+    } else if (espera <= 0) {
+        n = read(fd_maestro, bytes, sizeof(bytes));
+    }
+    pcFijarTiempo(milisUnidad());
+    for (i = 0; i < n; i++) {
+        pcRecibirUART(bytes[i], 0);
+    }
+}
+
+static void aplicarConfiguracion(void) {
+    char mensaje[64];
+    char *p;
+
+    getConfiguracion(&config);
+    setPeso(config.peso);
+
+    p = fmtCadena(mensaje, "Config: peso ");
+    p = fmtEntero(p, config.peso);
+    p = fmtCadena(p, " kg, comidas ");
+    p = config.hora1 >= 0 ? fmtHora(p, config.hora1, config.min1) : fmtCadena(p, "--:--");
+    p = fmtCadena(p, " y ");
+    p = config.hora2 >= 0 ? fmtHora(p, config.hora2, config.min2) : fmtCadena(p, "--:--");
+    p = fmtCadena(p, "\n\r");
+    writeUART(mensaje, p - mensaje);
+    protocoloEnviarEvento(EVT_CONFIG, config.peso);
+}
+
+// hhmm de la primera de las dos comidas que queda por delante, aunque sea
+// mañana, o 0xFFFF
+static uint16_t proximaComida(void) {
+    int comidas[2] = {-1, -1};
+    int mejor = -1, espera_mejor = 0;
+    int ahora, i;
+    instante_t instante;
+
+    getInstante(&instante);
+    ahora = instante.h * 60 + instante.m;
+    if (config.hora1 >= 0 && config.min1 >= 0) {
+        comidas[0] = config.hora1 * 60 + config.min1;
+    }
+    if (config.hora2 >= 0 && config.min2 >= 0) {
+        comidas[1] = config.hora2 * 60 + config.min2;
+    }
+    for (i = 0; i < 2; i++) {
+        int espera = (comidas[i] - ahora + 24 * 60) % (24 * 60);
+
+        if (comidas[i] >= 0 && (mejor < 0 || espera < espera_mejor)) {
+            mejor = comidas[i];
+            espera_mejor = espera;
+        }
+    }
+    return mejor < 0 ? 0xFFFF : (mejor / 60) * 100 + mejor % 60;
+}
+
+static void enviarEstadoTelemetria(void) {
+    telemetria_t t;
+
+    t.peso = config.peso;
+    t.racion = getRacion() * 2;
+    t.proxima = proximaComida();
+    t.comiendo = 0;
+    t.estado = ESTADO_REPOSO;
+    enviarTelemetria(&t);
+}
+
+static void tareaUart(const evento_tarea_t *evento) {
+    procesarUART();
+}
+
+static void tareaControl(const evento_tarea_t *evento) {
+    switch (evento->tipo) {
+        case EV_CONFIG:
+            aplicarConfiguracion();
+            break;
+
+        case EV_DISPENSADO:
+            protocoloEnviarEvento(EVT_DISPENSADO, evento->dato);
+            break;
+
+        case EV_TELEMETRIA:
+            enviarEstadoTelemetria();
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Pseudoterminal en modo crudo. El lado esclavo se deja abierto para que el
+// maestro no dé error mientras no haya ningún cliente.
+static int abrirPseudoterminal(char *ruta, size_t tam) {
+    struct termios tio;
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    int esclavo;
+
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0 || ptsname(fd) == NULL) {
+        return -1;
+    }
+    snprintf(ruta, tam, "%s", ptsname(fd));
+    esclavo = open(ruta, O_RDWR | O_NOCTTY);
+    if (esclavo < 0) {
+        return -1;
+    }
+    if (tcgetattr(esclavo, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(esclavo, TCSANOW, &tio);
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+static void ejecutarUnidad(int fd) {
+    time_t segundos = time(NULL);
+    struct tm *hora = localtime(&segundos);
+
+    fd_maestro = fd;
+    inicio_ms = ahoraMs();
+    pcFijarSalida(salida);
+    pcFijarEspera(esperar);
+
+    InicializarPlanificador();
+    crearTarea(&tarea_uart, "UART", 3, 20, EVENTO(EV_RX), tareaUart);
+    crearTarea(&tarea_control, "Control", 2, 100,
+               EVENTO(EV_CONFIG) | EVENTO(EV_DISPENSADO) | EVENTO(EV_TELEMETRIA), tareaControl);
+
+    InicializarUART1(9600);
+    InicializarTimer();
+    InicializarCalendario();
+    InicializarTemporizadores();
+    InicializarServo();
+    InicializarMascota();
+    InicializarTelemetria();
+    setHoraActual(hora->tm_hour, hora->tm_min, hora->tm_sec);
+
+    getConfiguracion(&config);
+    ejecutarPlanificador();
+}
+
+int main(int argc, char **argv) {
+    int unidades = 1;
+    int opcion, i;
+
+    while ((opcion = getopt(argc, argv, "n:")) != -1) {
+        if (opcion == 'n') {
+            unidades = atoi(optarg);
+        } else {
+            unidades = 0;
+            break;
+        }
+    }
+    if (unidades < 1 || unidades > MAX_UNIDADES) {
+        fprintf(stderr, "uso: %s [-n unidades (1 a %d)]\n", argv[0], MAX_UNIDADES);
+        return 1;
+    }
+
+    for (i = 0; i < unidades; i++) {
+        char ruta[64];
+        int fd = abrirPseudoterminal(ruta, sizeof(ruta));
+        pid_t pid;
+
+        if (fd < 0) {
+            fprintf(stderr, "pseudoterminal: %s\n", strerror(errno));
+            break;
+        }
+        printf("%s\n", ruta);
+        fflush(stdout);
+        pid = fork();
+        if (pid == 0) {
+            ejecutarUnidad(fd);
+            _exit(0);
+        }
+        close(fd);
+        if (pid < 0) {
+            fprintf(stderr, "fork: %s\n", strerror(errno));
+            break;
+        }
+    }
+    // Las unidades acaban con el grupo de procesos
+    while (wait(NULL) > 0)
+        ;
+    return 0;
+}
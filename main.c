@@ -1,5 +1,4 @@
 #include <xc.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 
@@ -10,8 +9,23 @@
 #include "Timer.h"
 #include "Buzzer.h"
 #include "Servo.h"
-
-#define PIN_INPUT 4
+#include "Protocolo.h"
+#include "Formato.h"
+#include "Telemetria.h"
+#include "Registro.h"
+#include "Temporizadores.h"
+#include "Sensor.h"
+#include "Calendario.h"
+#include "Perfil.h"
+#include "Planificador.h"
+#include "SeccionCritica.h"
+
+#define MS_BIENVENIDA 2000
+#define MS_PANTALLA_ESTADO 4000
+#define MS_ARRANQUE_SENSOR 5000
+#define MS_ANTIRREBOTE 3000
+#define MS_PASO_ANIMACION 500
+#define PASO_LISTO 6 // La barra avanza de 20 en 20 en los pasos 0 a 5
 
 extern uint8_t SmallFont[];
 extern const unsigned short dog[];
@@ -27,198 +41,328 @@ typedef enum {
 void mostrarPerrito(void);
 void mostrarInicio(void);
 void mostrarEstado(int peso, int racion, int h1, int m1, int h2, int m2);
-void animarDispensado(void);
+void animarDispensado(int desde_cero, int paso);
+uint16_t proximaComida(const instante_t *instante, int dia_semana,
+                       int h1, int m1, int dias1, int h2, int m2, int dias2);
 
 char buffer_global[164];
 
-void esperarMs(uint32_t ms) {
-    uint32_t inicio = getTiempoAbsoluto();
-    while ((getTiempoAbsoluto() - inicio) < ms);
+// Todo lo que sigue lo tocan solo las tareas y las funciones de los
+// temporizadores, que se ejecutan de una en una desde el planificador.
+static EstadoSistema estado = EST_BIENVENIDA;
+static int pantalla_dibujada = -1;
+static int paso_animacion = 0;
+static int uart_habilitada = 0;
+static uint8_t sensor_habilitado = 0;
+static int estado_confirmado;
+static int estado_en_evaluacion = -1;
+
+static config_t config;
+static int racion;
+static int minuto_anterior = -1;
+static int rutina1_ejecutada = 0;
+static int rutina2_ejecutada = 0;
+
+static tarea_t tarea_uart;
+static tarea_t tarea_control;
+static tarea_t tarea_pantalla;
+
+static temporizador_t temporizador_bienvenida;
+static temporizador_t temporizador_estado;
+static temporizador_t temporizador_sensor;
+static temporizador_t temporizador_antirrebote;
+static temporizador_t temporizador_animacion;
+static temporizador_t temporizador_minuto;
+
+static void cambiarPantalla(EstadoSistema nueva) {
+    estado = nueva;
+    publicarEvento(EV_PANTALLA, nueva);
 }
 
-int main(void) {
-    TRISA = 0;
-    TRISB = 1 << 5;
-    TRISC = 1 << PIN_INPUT;
+static void finBienvenida(void *dato) {
+    uart_habilitada = 1;
+    cambiarPantalla(EST_PERRITO);
+}
 
-    LATA = 0;
-    LATB = 0;
-    LATC = 0xF;
+static void finPantallaEstado(void *dato) {
+    if (estado == EST_ESTADO) {
+        cambiarPantalla(EST_PERRITO);
+    }
+}
 
-    inicializarTFT(LANDSCAPE);
-    setFont(SmallFont);
-    InicializarUART1(9600);
-    InicializarTimer();
-    InicializarBuzzer();
-    InicializarServo();
-    clearUart();
+static void habilitarSensor(void *dato) {
+    sensor_habilitado = 1;
+    publicarEvento(EV_SENSOR, leerSensor());
+}
 
-    int peso = getPeso();
-    int racion = getRacion();
-    int hora1 = -1, min1 = -1;
-    int hora2 = -1, min2 = -1;
+// La lectura ha sido distinta de la confirmada durante todo el antirrebote
+static void confirmarSensor(void *dato) {
+    estado_confirmado = estado_en_evaluacion;
+    estado_en_evaluacion = -1;
 
-    int minuto_anterior = -1;
-    int rutina1_ejecutada = 0;
-    int rutina2_ejecutada = 0;
+    if (estado_confirmado == 1) {
+        registrar(REG_INFO, "Ha parado de comer!!!");
+        protocoloEnviarEvento(EVT_PARA_DE_COMER, 0);
+    } else {
+        registrar(REG_INFO, "Esta comiendo!!!");
+        protocoloEnviarEvento(EVT_COMIENDO, 0);
+    }
+}
 
-    int mostrar_estado_comida = 0;
+// Cada paso es un evento para la tarea de pantalla; tras "Listo" se deja un
+// paso más antes de volver al perrito.
+static void pasoAnimacion(void *dato) {
+    if (estado != EST_DISPENSANDO) {
+        pararTemporizador(&temporizador_animacion);
+        return;
+    }
+    paso_animacion++;
+    if (paso_animacion <= PASO_LISTO) {
+        publicarEvento(EV_PANTALLA, EST_DISPENSANDO);
+    } else if (paso_animacion > PASO_LISTO + 1) {
+        pararTemporizador(&temporizador_animacion);
+        cambiarPantalla(EST_PERRITO);
+    }
+}
 
-    EstadoSistema estado = EST_BIENVENIDA;
-    EstadoSistema estado_anterior_sistema = -1;
+static void avisoMinuto(void *dato);
 
-    int uart_habilitada = 0;
-    uint8_t sensor_habilitado = 0;
-    uint32_t tiempo_inicio_sistema = getTiempoAbsoluto();
-    uint32_t tiempo_inicio_estado_config = 0;
-    uint32_t tiempo_inicio_bienvenida = getTiempoAbsoluto();
-    uint8_t esperando_bienvenida = 1;
+// Vence en el próximo cambio de minuto del reloj, sin sondearlo. Se recalcula
+// cada vez, así que sigue los ajustes de hora.
+static void armarAvisoMinuto(void) {
+    instante_t instante;
 
-    int estado_confirmado = (PORTC >> PIN_INPUT) & 1;
-    int estado_en_evaluacion = -1;
-    uint32_t tiempo_cambio_ms = 0;
-    uint32_t umbral_antirrebote_ms = 3000;
+    getInstante(&instante);
+    iniciarTemporizador(&temporizador_minuto, (60 - instante.s) * 1000 - instante.ms, 0, avisoMinuto, NULL);
+}
 
-    if (estado_confirmado == 1) {
-        putsUART("Ha parado de comer!!!\n\r");
-    } else {
-        putsUART("Esta comiendo!!!\n\r");
+static void avisoMinuto(void *dato) {
+    armarAvisoMinuto();
+    publicarEvento(EV_MINUTO, 0);
+}
+
+static void servirComida(const char *mensaje) {
+    registrarValor(REG_INFO, mensaje, getRacion());
+    reproducirMelodia();
+    dispensar(getRacion());
+
+    paso_animacion = 0;
+    pantalla_dibujada = -1;
+    cambiarPantalla(EST_DISPENSANDO);
+    iniciarTemporizador(&temporizador_animacion, MS_PASO_ANIMACION, MS_PASO_ANIMACION, pasoAnimacion, NULL);
+}
+
+// Día de la semana del instante de Timer.c. Se toma del RTCC, que se lee
+// después y puede ir a un lado u otro de la medianoche: se corrige con su hora.
+static int diaSemanaDe(const instante_t *instante) {
+    fecha_t fecha;
+
+    getFecha(&fecha);
+    if (instante->h == 0 && fecha.h == 23) {
+        return (fecha.dia_semana + 1) % 7;
     }
+    if (instante->h == 23 && fecha.h == 0) {
+        return (fecha.dia_semana + 6) % 7;
+    }
+    return fecha.dia_semana;
+}
 
-    mostrarInicio();
+static void comprobarComidas(void) {
+    instante_t instante;
+    int hoy;
 
-    while (1) {
-        uint32_t ahora = getTiempoAbsoluto();
+    getInstante(&instante);
+    hoy = 1 << diaSemanaDe(&instante);
+    if (instante.m != minuto_anterior) {
+        rutina1_ejecutada = 0;
+        rutina2_ejecutada = 0;
+        minuto_anterior = instante.m;
+    }
 
-        if (esperando_bienvenida && ahora - tiempo_inicio_bienvenida >= 2000) {
-            esperando_bienvenida = 0;
-            uart_habilitada = 1;
-            estado = EST_PERRITO;
-        }
+    if (instante.h == config.hora1 && instante.m == config.min1 && (config.dias1 & hoy) && !rutina1_ejecutada) {
+        servirComida("Primera comida, g: ");
+        rutina1_ejecutada = 1;
+    }
 
-        if (estado == EST_ESTADO && ahora - tiempo_inicio_estado_config >= 4000) {
-            estado = EST_PERRITO;
-        }
+    if (instante.h == config.hora2 && instante.m == config.min2 && (config.dias2 & hoy) && !rutina2_ejecutada) {
+        servirComida("Segunda comida, g: ");
+        rutina2_ejecutada = 1;
+    }
+}
 
-        if (uart_habilitada && hayNuevoPeso()) {
-            peso = getPesoUART();
-            setPeso(peso);
-            racion = getRacion();
-            sprintf(buffer_global, "Peso actualizado: %d\n\r", peso);
-            putsUART(buffer_global);
+// La configuración llega ya validada y completa: un solo aviso y un solo
+// redibujado aunque cambien varios campos.
+static void aplicarConfiguracion(void) {
+    char *p;
+
+    getConfiguracion(&config);
+    setPeso(config.peso);
+    racion = getRacion();
+
+    p = fmtCadena(buffer_global, "Config: peso ");
+    p = fmtEntero(p, config.peso);
+    p = fmtCadena(p, " kg, comidas ");
+    p = config.hora1 >= 0 ? fmtHora(p, config.hora1, config.min1) : fmtCadena(p, "--:--");
+    p = fmtCadena(p, " y ");
+    p = config.hora2 >= 0 ? fmtHora(p, config.hora2, config.min2) : fmtCadena(p, "--:--");
+    p = fmtCadena(p, "\n\r");
+    writeUART(buffer_global, p - buffer_global);
+    protocoloEnviarEvento(EVT_CONFIG, config.peso);
+
+    // Una comida programada para el minuto en curso se sirve ya
+    comprobarComidas();
+
+    if (uart_habilitada && estado != EST_DISPENSANDO) {
+        cambiarPantalla(EST_ESTADO);
+        iniciarTemporizador(&temporizador_estado, MS_PANTALLA_ESTADO, 0, finPantallaEstado, NULL);
+    }
+}
+
+// Se lee el pin al atender el evento y no el nivel que vio la ISR: si la cola
+// se llenó con rebotes, el último evento encolado ve igualmente el nivel final.
+static void evaluarSensor(void) {
+    int lectura_estado;
 
-            mostrarEstado(peso, racion, hora1, min1, hora2, min2);
-            estado = EST_ESTADO;
-            tiempo_inicio_estado_config = ahora;
+    if (!sensor_habilitado) {
+        return;
+    }
+    lectura_estado = leerSensor();
+    if (lectura_estado != estado_confirmado) {
+        if (lectura_estado != estado_en_evaluacion) {
+            estado_en_evaluacion = lectura_estado;
+            iniciarTemporizador(&temporizador_antirrebote, MS_ANTIRREBOTE, 0, confirmarSensor, NULL);
         }
+    } else if (estado_en_evaluacion != -1) {
+        estado_en_evaluacion = -1;
+        pararTemporizador(&temporizador_antirrebote);
+    }
+}
 
-        if (uart_habilitada && hayPrimeraHoraNueva()) {
-            hora1 = getHoraPrimera();
-            min1 = getMinPrimera();
-            sprintf(buffer_global, "Primera comida: %02d:%02d\n\r", hora1, min1);
-            putsUART(buffer_global);
+static void enviarEstadoTelemetria(void) {
+    telemetria_t t;
+    instante_t instante;
+
+    getInstante(&instante);
+    t.peso = config.peso;
+    t.racion = racion * 2;
+    t.proxima = proximaComida(&instante, diaSemanaDe(&instante), config.hora1, config.min1,
+                              config.dias1, config.hora2, config.min2, config.dias2);
+    t.comiendo = estado_confirmado == 0;
+    t.estado = estado;
+    enviarTelemetria(&t);
+}
 
-            mostrarEstado(peso, racion, hora1, min1, hora2, min2);
-            estado = EST_ESTADO;
-            tiempo_inicio_estado_config = ahora;
-        }
+static void tareaUart(const evento_tarea_t *evento) {
+    procesarUART();
+}
 
-        if (uart_habilitada && haySegundaHoraNueva()) {
-            hora2 = getHoraSegunda();
-            min2 = getMinSegunda();
-            sprintf(buffer_global, "Segunda comida: %02d:%02d\n\r", hora2, min2);
-            putsUART(buffer_global);
+static void tareaControl(const evento_tarea_t *evento) {
+    switch (evento->tipo) {
+        case EV_CONFIG:
+            aplicarConfiguracion();
+            break;
 
-            mostrarEstado(peso, racion, hora1, min1, hora2, min2);
-            estado = EST_ESTADO;
-            tiempo_inicio_estado_config = ahora;
-        }
+        case EV_MINUTO:
+            comprobarComidas();
+            break;
 
-        if (!sensor_habilitado && (ahora - tiempo_inicio_sistema > 5000)) {
-            sensor_habilitado = 1;
-        }
+        case EV_SENSOR:
+            evaluarSensor();
+            break;
 
-        int minuto_actual = getMinutoActual();
-        if (minuto_actual != minuto_anterior) {
-            rutina1_ejecutada = 0;
-            rutina2_ejecutada = 0;
-            minuto_anterior = minuto_actual;
-        }
+        case EV_DISPENSADO:
+            protocoloEnviarEvento(EVT_DISPENSADO, evento->dato);
+            break;
 
-        int hora_actual = getHoraActual();
+        case EV_TELEMETRIA:
+            enviarEstadoTelemetria();
+            break;
 
-        if (hora_actual == hora1 && minuto_actual == min1 && !rutina1_ejecutada) {
-            reproducirMelodia();
-            dispensar(getRacion());
-            estado = EST_DISPENSANDO;
-            rutina1_ejecutada = 1;
-        }
+        default:
+            break;
+    }
+}
 
-        if (hora_actual == hora2 && minuto_actual == min2 && !rutina2_ejecutada) {
-            reproducirMelodia();
-            dispensar(getRacion());
-            estado = EST_DISPENSANDO;
-            rutina2_ejecutada = 1;
-        }
+// Los eventos de una pantalla que ya se ha dejado se descartan.
+static void tareaPantalla(const evento_tarea_t *evento) {
+    if (evento->dato != estado) {
+        return;
+    }
+    switch (estado) {
+        case EST_BIENVENIDA:
+            mostrarInicio();
+            break;
 
-        if (sensor_habilitado) {
-            int lectura_estado = (PORTC >> PIN_INPUT) & 1;
-
-            if (lectura_estado != estado_confirmado) {
-                if (lectura_estado != estado_en_evaluacion) {
-                    estado_en_evaluacion = lectura_estado;
-                    tiempo_cambio_ms = ahora;
-                } else {
-                    if ((ahora - tiempo_cambio_ms) >= umbral_antirrebote_ms) {
-                        estado_confirmado = lectura_estado;
-                        estado_en_evaluacion = -1;
-
-                        if (estado_confirmado == 1) {
-                            mostrar_estado_comida = 1;
-                            putsUART("Ha parado de comer!!!\n\r");
-                        } else {
-                            putsUART("Esta comiendo!!!\n\r");
-                        }
-                    }
-                }
-            } else {
-                estado_en_evaluacion = -1; 
-            }
-        }
+        case EST_ESTADO:
+            mostrarEstado(config.peso, racion, config.hora1, config.min1, config.hora2, config.min2);
+            break;
 
-        if (estado != estado_anterior_sistema) {
-            switch (estado) {
-                case EST_INICIO:
-                    mostrarInicio();
-                    tiempo_inicio_bienvenida = ahora;
-                    esperando_bienvenida = 1;
-                    estado_anterior_sistema = estado;
-                    break;
-
-                case EST_ESTADO:
-                    if (mostrar_estado_comida) {
-                        mostrarEstado(peso, racion, hora1, min1, hora2, min2);
-                        mostrar_estado_comida = 0;
-                    }
-                    estado_anterior_sistema = estado;
-                    break;
-
-                case EST_DISPENSANDO:
-                    animarDispensado();
-                    estado = EST_PERRITO;
-                    estado_anterior_sistema = -1;
-                    break;
-
-                case EST_PERRITO:
-                    mostrarPerrito();
-                    estado_anterior_sistema = estado;
-                    break;
-
-                default:
-                    break;
-            }
-        }
+        case EST_DISPENSANDO:
+            animarDispensado(pantalla_dibujada != EST_DISPENSANDO, paso_animacion);
+            break;
+
+        case EST_PERRITO:
+            mostrarPerrito();
+            break;
+
+        default:
+            break;
     }
+    pantalla_dibujada = estado;
+}
+
+int main(void) {
+    TRISA = 0;
+    TRISB = 1 << 5;
+    TRISC = 1 << PIN_SENSOR;
+
+    LATA = 0;
+    LATB = 0;
+    LATC = 0xF;
+
+    // Las tareas existen antes que las interrupciones que les publican
+    InicializarPlanificador();
+    crearTarea(&tarea_uart, "UART", 3, 20, EVENTO(EV_RX), tareaUart);
+    crearTarea(&tarea_control, "Control", 2, 100,
+               EVENTO(EV_CONFIG) | EVENTO(EV_MINUTO) | EVENTO(EV_SENSOR) |
+               EVENTO(EV_DISPENSADO) | EVENTO(EV_TELEMETRIA), tareaControl);
+    crearTarea(&tarea_pantalla, "Pantalla", 1, 500, EVENTO(EV_PANTALLA), tareaPantalla);
+
+    inicializarTFT(LANDSCAPE);
+    setFont(SmallFont);
+    InicializarUART1(9600);
+    InicializarRegistro(115200);
+    InicializarTimer();
+    InicializarCalendario();
+    InicializarTemporizadores();
+    InicializarBuzzer();
+    InicializarServo();
+    InicializarMascota();
+    InicializarTelemetria();
+    InicializarSensor();
+    InicializarPerfil();
+    InicializarSeccionCritica();
+    clearUart();
+
+    getConfiguracion(&config);
+    racion = getRacion();
+
+    estado_confirmado = leerSensor();
+    iniciarTemporizador(&temporizador_bienvenida, MS_BIENVENIDA, 0, finBienvenida, NULL);
+    iniciarTemporizador(&temporizador_sensor, MS_ARRANQUE_SENSOR, 0, habilitarSensor, NULL);
+    armarAvisoMinuto();
+
+    if (estado_confirmado == 1) {
+        registrar(REG_INFO, "Ha parado de comer!!!");
+    } else {
+        registrar(REG_INFO, "Esta comiendo!!!");
+    }
+
+    mostrarInicio();
+    pantalla_dibujada = EST_BIENVENIDA;
+
+    ejecutarPlanificador();
+    return 0;
 }
 
 
@@ -245,35 +389,81 @@ void mostrarEstado(int peso, int racion, int h1, int m1, int h2, int m2) {
     print("CONFIGURACION ACTUAL", CENTER, 5, 0);
     setColor(VGA_WHITE);
 
-    sprintf(buffer_global, "Peso: %d kg", peso);
+    char *p;
+
+    p = fmtCadena(buffer_global, "Peso: ");
+    p = fmtEntero(p, peso);
+    fmtCadena(p, " kg");
     print(buffer_global, LEFT, 30, 0);
 
-    sprintf(buffer_global, "Racion: %d g", racion);
+    p = fmtCadena(buffer_global, "Racion: ");
+    p = fmtEntero(p, racion);
+    fmtCadena(p, " g");
     print(buffer_global, LEFT, 50, 0);
 
+    p = fmtCadena(buffer_global, "1era comida: ");
     if (h1 >= 0 && m1 >= 0)
-        sprintf(buffer_global, "1era comida: %02d:%02d", h1, m1);
+        fmtHora(p, h1, m1);
     else
-        sprintf(buffer_global, "1era comida: --:--");
+        fmtCadena(p, "--:--");
     print(buffer_global, LEFT, 70, 0);
 
+    p = fmtCadena(buffer_global, "2da comida: ");
     if (h2 >= 0 && m2 >= 0)
-        sprintf(buffer_global, "2da comida: %02d:%02d", h2, m2);
+        fmtHora(p, h2, m2);
     else
-        sprintf(buffer_global, "2da comida: --:--");
+        fmtCadena(p, "--:--");
     print(buffer_global, LEFT, 90, 0);
 }
 
-void animarDispensado(void) {
-    clrScr();
-    setColor(VGA_RED);
-    print("Dispensando comida!", CENTER, 30, 0);
+// Devuelve la siguiente comida programada como hhmm, o 0xFFFF si no hay.
+// Cada comida solo cuenta los días de su máscara, así que la siguiente puede
+// ser la de otro día; como mucho, la de hoy a la misma hora dentro de 7 días.
+uint16_t proximaComida(const instante_t *instante, int dia_semana,
+                       int h1, int m1, int dias1, int h2, int m2, int dias2) {
+    int ahora = instante->h * 60 + instante->m;
+    int comidas[2], dias[2];
+    int mejor = -1, espera_mejor = 0;
+    int i;
+
+    comidas[0] = (h1 >= 0 && m1 >= 0) ? h1 * 60 + m1 : -1;
+    comidas[1] = (h2 >= 0 && m2 >= 0) ? h2 * 60 + m2 : -1;
+    dias[0] = dias1;
+    dias[1] = dias2;
+    for (i = 0; i < 2; i++) {
+        int d;
+
+        if (comidas[i] < 0) {
+            continue;
+        }
+        for (d = 0; d <= 7; d++) {
+            int espera = d * 24 * 60 + comidas[i] - ahora;
+
+            if (espera < 0 || !(dias[i] & (1 << ((dia_semana + d) % 7)))) {
+                continue;
+            }
+            if (mejor < 0 || espera < espera_mejor) {
+                mejor = comidas[i];
+                espera_mejor = espera;
+            }
+            break;
+        }
+    }
+    return mejor < 0 ? 0xFFFF : (mejor / 60) * 100 + mejor % 60;
+}
+
+// Dibuja la animación hasta el paso indicado. Repetir un paso no cambia
+// nada, así que da igual si la tarea se ha saltado alguno.
+void animarDispensado(int desde_cero, int paso) {
+    if (desde_cero) {
+        clrScr();
+        setColor(VGA_RED);
+        print("Dispensando comida!", CENTER, 30, 0);
+    }
     setColor(VGA_GREEN);
-    for (int i = 0; i <= 100; i += 20) {
-        fillRect(30, 70, 30 + i, 90);
-        esperarMs(500);
+    fillRect(30, 70, 30 + 20 * (paso < PASO_LISTO ? paso : PASO_LISTO - 1), 90);
+    if (paso >= PASO_LISTO) {
+        setColor(VGA_WHITE);
+        print("Listo! A comer", CENTER, 110, 0);
     }
-    setColor(VGA_WHITE);
-    print("Listo! A comer", CENTER, 110, 0);
-    esperarMs(1000);
 }
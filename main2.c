@@ -1,9 +1,11 @@
 #include <xc.h>
 #include "Pic32Ini.h"
 #include "Uart.h"
+#include "Formato.h"
 #include "Mascota.h"
 #include "Timer.h"
 #include "Buzzer.h"
+#include "Temporizadores.h"
 #include "Servo.h"
 
 #define PIN_PULSADOR 5
@@ -23,9 +25,11 @@ int main(void) {
     int hora2 = -1, min2 = -1;
     int peso = -1;
     char buffer[64];
+    char *p;
 
     InicializarUART1(9600);
     InicializarTimer();
+    InicializarTemporizadores();
     InicializarBuzzer();
     InicializarServo();
     
@@ -44,25 +48,34 @@ int main(void) {
     int tiempo_cambio = getSegundos();
 
     while (1) {
+        procesarTemporizadores(getTiempoAbsoluto()); // La compuerta la cierra un temporizador
+        procesarUART();
+
         if (hayNuevoPeso()) {
             peso = getPesoUART();
             setPeso(peso);
-            sprintf(buffer, "Peso actualizado: %d\n\r", peso);
-            putsUART(buffer);
+            p = fmtCadena(buffer, "Peso actualizado: ");
+            p = fmtEntero(p, peso);
+            p = fmtCadena(p, "\n\r");
+            writeUART(buffer, p - buffer);
         }
 
         if (hayPrimeraHoraNueva()) {
             hora1 = getHoraPrimera();
             min1 = getMinPrimera();
-            sprintf(buffer, "Primera comida programada a las %02d:%02d\n\r", hora1, min1);
-            putsUART(buffer);
+            p = fmtCadena(buffer, "Primera comida programada a las ");
+            p = fmtHora(p, hora1, min1);
+            p = fmtCadena(p, "\n\r");
+            writeUART(buffer, p - buffer);
         }
 
         if (haySegundaHoraNueva()) {
             hora2 = getHoraSegunda();
             min2 = getMinSegunda();
-            sprintf(buffer, "Segunda comida programada a las %02d:%02d\n\r", hora2, min2);
-            putsUART(buffer);
+            p = fmtCadena(buffer, "Segunda comida programada a las ");
+            p = fmtHora(p, hora2, min2);
+            p = fmtCadena(p, "\n\r");
+            writeUART(buffer, p - buffer);
         }
 
         int minuto_actual = getMinutoActual();
@@ -1,5 +1,4 @@
 #include <xc.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include "Pic32Ini.h"
@@ -9,6 +8,7 @@
 #include "Timer.h"
 #include "Buzzer.h"
 #include "Servo.h"
+#include "Formato.h"
 
 #define PIN_PULSADOR 5
 #define PIN_INPUT 4
@@ -54,6 +54,7 @@ int main(void) {
     int hora2 = -1, min2 = -1;
     int peso = -1;
     char buffer[64];
+    char *p;
 
     int pulsador_ant = (PORTB >> PIN_PULSADOR) & 1;
     int pulsador_act;
@@ -70,25 +71,33 @@ int main(void) {
     clearUart();
 
     while (1) {
+        procesarUART();
+
         if (hayNuevoPeso()) {
             peso = getPesoUART();
             setPeso(peso);
-            sprintf(buffer, "Peso actualizado: %d\n\r", peso);
-            putsUART(buffer);
+            p = fmtCadena(buffer, "Peso actualizado: ");
+            p = fmtEntero(p, peso);
+            p = fmtCadena(p, "\n\r");
+            writeUART(buffer, p - buffer);
         }
 
         if (hayPrimeraHoraNueva()) {
             hora1 = getHoraPrimera();
             min1 = getMinPrimera();
-            sprintf(buffer, "Primera comida programada a las %02d:%02d\n\r", hora1, min1);
-            putsUART(buffer);
+            p = fmtCadena(buffer, "Primera comida programada a las ");
+            p = fmtHora(p, hora1, min1);
+            p = fmtCadena(p, "\n\r");
+            writeUART(buffer, p - buffer);
         }
 
         if (haySegundaHoraNueva()) {
             hora2 = getHoraSegunda();
             min2 = getMinSegunda();
-            sprintf(buffer, "Segunda comida programada a las %02d:%02d\n\r", hora2, min2);
-            putsUART(buffer);
+            p = fmtCadena(buffer, "Segunda comida programada a las ");
+            p = fmtHora(p, hora2, min2);
+            p = fmtCadena(p, "\n\r");
+            writeUART(buffer, p - buffer);
         }
 
         int minuto_actual = getMinutoActual();
@@ -216,7 +225,9 @@ void mostrarEstado(int peso) {
     print("Estado del sistema", CENTER, 10, 0);
     char buffer[32];
     setColor(VGA_WHITE);
-    sprintf(buffer, "Comida restante: %d g", peso);
+    char *p = fmtCadena(buffer, "Comida restante: ");
+    p = fmtEntero(p, peso);
+    fmtCadena(p, " g");
     print(buffer, LEFT, 40, 0);
     print("Ultima vez: --:--", LEFT, 60, 0);
     print("Modo: Automatico", LEFT, 80, 0);
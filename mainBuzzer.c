@@ -1,6 +1,7 @@
 #include <xc.h>
 #include "Pic32Ini.h"
 #include "Buzzer.h"
+#include "Timer.h"
 
 #define PIN_PULSADOR 5
 
@@ -8,11 +9,9 @@ int main(void) {
     int pulsador_ant;
     int pulsador_act;
 
+    InicializarTimer(); // Las notas las cambia la ISR del Timer1
     InicializarBuzzer();
 
-    INTCON |= 1 << 12;
-    asm("ei");
-
     pulsador_ant = (PORTB >> PIN_PULSADOR) & 1;
 
     while (1) {
@@ -4,6 +4,7 @@
 #include "Pic32Ini.h"
 #include "Servo.h"
 #include "Timer.h"
+#include "Temporizadores.h"
 
 #define PIN_PULSADOR 5
 
@@ -19,12 +20,14 @@ int main(void) {
     LATC = 0xF;
     
     InicializarTimer();
+    InicializarTemporizadores();
     InicializarServo();
 
     int pulsador_ant = (PORTB >> PIN_PULSADOR) & 1;
     int pulsador_act;
     
     while(1){
+        procesarTemporizadores(getTiempoAbsoluto()); // La compuerta la cierra un temporizador
         
         pulsador_act = (PORTB >> PIN_PULSADOR) & 1;
         
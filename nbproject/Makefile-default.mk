@@ -51,17 +51,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=TftDriver/DefaultFonts.c TftDriver/spi.c TftDriver/TftDriver.c TftDriver/dog.c Pic32Ini.c Buzzer.c Mascota.c Servo.c Timer.c Uart.c main.c
+SOURCEFILES_QUOTED_IF_SPACED=TftDriver/DefaultFonts.c TftDriver/spi.c TftDriver/TftDriver.c TftDriver/dog.c Pic32Ini.c Buzzer.c Mascota.c Servo.c Timer.c Uart.c Cola.c Comandos.c Protocolo.c Formato.c Telemetria.c Registro.c Temporizadores.c Sensor.c Calendario.c Perfil.c Retardo.c Planificador.c SeccionCritica.c main.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/TftDriver/DefaultFonts.o ${OBJECTDIR}/TftDriver/spi.o ${OBJECTDIR}/TftDriver/TftDriver.o ${OBJECTDIR}/TftDriver/dog.o ${OBJECTDIR}/Pic32Ini.o ${OBJECTDIR}/Buzzer.o ${OBJECTDIR}/Mascota.o ${OBJECTDIR}/Servo.o ${OBJECTDIR}/Timer.o ${OBJECTDIR}/Uart.o ${OBJECTDIR}/main.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/TftDriver/DefaultFonts.o.d ${OBJECTDIR}/TftDriver/spi.o.d ${OBJECTDIR}/TftDriver/TftDriver.o.d ${OBJECTDIR}/TftDriver/dog.o.d ${OBJECTDIR}/Pic32Ini.o.d ${OBJECTDIR}/Buzzer.o.d ${OBJECTDIR}/Mascota.o.d ${OBJECTDIR}/Servo.o.d ${OBJECTDIR}/Timer.o.d ${OBJECTDIR}/Uart.o.d ${OBJECTDIR}/main.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/TftDriver/DefaultFonts.o ${OBJECTDIR}/TftDriver/spi.o ${OBJECTDIR}/TftDriver/TftDriver.o ${OBJECTDIR}/TftDriver/dog.o ${OBJECTDIR}/Pic32Ini.o ${OBJECTDIR}/Buzzer.o ${OBJECTDIR}/Mascota.o ${OBJECTDIR}/Servo.o ${OBJECTDIR}/Timer.o ${OBJECTDIR}/Uart.o ${OBJECTDIR}/Cola.o ${OBJECTDIR}/Comandos.o ${OBJECTDIR}/Protocolo.o ${OBJECTDIR}/Formato.o ${OBJECTDIR}/Telemetria.o ${OBJECTDIR}/Registro.o ${OBJECTDIR}/Temporizadores.o ${OBJECTDIR}/Sensor.o ${OBJECTDIR}/Calendario.o ${OBJECTDIR}/Perfil.o ${OBJECTDIR}/Retardo.o ${OBJECTDIR}/Planificador.o ${OBJECTDIR}/SeccionCritica.o ${OBJECTDIR}/main.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/TftDriver/DefaultFonts.o.d ${OBJECTDIR}/TftDriver/spi.o.d ${OBJECTDIR}/TftDriver/TftDriver.o.d ${OBJECTDIR}/TftDriver/dog.o.d ${OBJECTDIR}/Pic32Ini.o.d ${OBJECTDIR}/Buzzer.o.d ${OBJECTDIR}/Mascota.o.d ${OBJECTDIR}/Servo.o.d ${OBJECTDIR}/Timer.o.d ${OBJECTDIR}/Uart.o.d ${OBJECTDIR}/Cola.o.d ${OBJECTDIR}/Comandos.o.d ${OBJECTDIR}/Protocolo.o.d ${OBJECTDIR}/Formato.o.d ${OBJECTDIR}/Telemetria.o.d ${OBJECTDIR}/Registro.o.d ${OBJECTDIR}/Temporizadores.o.d ${OBJECTDIR}/Sensor.o.d ${OBJECTDIR}/Calendario.o.d ${OBJECTDIR}/Perfil.o.d ${OBJECTDIR}/Retardo.o.d ${OBJECTDIR}/Planificador.o.d ${OBJECTDIR}/SeccionCritica.o.d ${OBJECTDIR}/main.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/TftDriver/DefaultFonts.o ${OBJECTDIR}/TftDriver/spi.o ${OBJECTDIR}/TftDriver/TftDriver.o ${OBJECTDIR}/TftDriver/dog.o ${OBJECTDIR}/Pic32Ini.o ${OBJECTDIR}/Buzzer.o ${OBJECTDIR}/Mascota.o ${OBJECTDIR}/Servo.o ${OBJECTDIR}/Timer.o ${OBJECTDIR}/Uart.o ${OBJECTDIR}/main.o
+OBJECTFILES=${OBJECTDIR}/TftDriver/DefaultFonts.o ${OBJECTDIR}/TftDriver/spi.o ${OBJECTDIR}/TftDriver/TftDriver.o ${OBJECTDIR}/TftDriver/dog.o ${OBJECTDIR}/Pic32Ini.o ${OBJECTDIR}/Buzzer.o ${OBJECTDIR}/Mascota.o ${OBJECTDIR}/Servo.o ${OBJECTDIR}/Timer.o ${OBJECTDIR}/Uart.o ${OBJECTDIR}/Cola.o ${OBJECTDIR}/Comandos.o ${OBJECTDIR}/Protocolo.o ${OBJECTDIR}/Formato.o ${OBJECTDIR}/Telemetria.o ${OBJECTDIR}/Registro.o ${OBJECTDIR}/Temporizadores.o ${OBJECTDIR}/Sensor.o ${OBJECTDIR}/Calendario.o ${OBJECTDIR}/Perfil.o ${OBJECTDIR}/Retardo.o ${OBJECTDIR}/Planificador.o ${OBJECTDIR}/SeccionCritica.o ${OBJECTDIR}/main.o
 
 # Source Files
-SOURCEFILES=TftDriver/DefaultFonts.c TftDriver/spi.c TftDriver/TftDriver.c TftDriver/dog.c Pic32Ini.c Buzzer.c Mascota.c Servo.c Timer.c Uart.c main.c
+SOURCEFILES=TftDriver/DefaultFonts.c TftDriver/spi.c TftDriver/TftDriver.c TftDriver/dog.c Pic32Ini.c Buzzer.c Mascota.c Servo.c Timer.c Uart.c Cola.c Comandos.c Protocolo.c Formato.c Telemetria.c Registro.c Temporizadores.c Sensor.c Calendario.c Perfil.c Retardo.c Planificador.c SeccionCritica.c main.c
 
 
 
@@ -161,6 +161,84 @@ ${OBJECTDIR}/Uart.o: Uart.c  .generated_files/flags/default/e5dffdfbe51a445767e6
 	@${RM} ${OBJECTDIR}/Uart.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Uart.o.d" -o ${OBJECTDIR}/Uart.o Uart.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/Cola.o: Cola.c  .generated_files/flags/default/d0825c92ce2f35fc930be0d4849cfebbafa166d8 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Cola.o.d 
+	@${RM} ${OBJECTDIR}/Cola.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Cola.o.d" -o ${OBJECTDIR}/Cola.o Cola.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Comandos.o: Comandos.c  .generated_files/flags/default/2138758f9bed98f37227c457b8ba58f0423e9aae .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Comandos.o.d 
+	@${RM} ${OBJECTDIR}/Comandos.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Comandos.o.d" -o ${OBJECTDIR}/Comandos.o Comandos.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Protocolo.o: Protocolo.c  .generated_files/flags/default/f82e897bd47138c37a19f85a02df67814018b668 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Protocolo.o.d 
+	@${RM} ${OBJECTDIR}/Protocolo.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Protocolo.o.d" -o ${OBJECTDIR}/Protocolo.o Protocolo.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Formato.o: Formato.c  .generated_files/flags/default/36593d486d1403ee5a7721c6ab5aebac16eec61f .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Formato.o.d 
+	@${RM} ${OBJECTDIR}/Formato.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Formato.o.d" -o ${OBJECTDIR}/Formato.o Formato.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Telemetria.o: Telemetria.c  .generated_files/flags/default/e33c09c9e8dc71ef03d190c367473a2b5b567a74 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Telemetria.o.d 
+	@${RM} ${OBJECTDIR}/Telemetria.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Telemetria.o.d" -o ${OBJECTDIR}/Telemetria.o Telemetria.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Registro.o: Registro.c  .generated_files/flags/default/fdc49c99767cd5dd13b434582e154a9e97903756 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Registro.o.d 
+	@${RM} ${OBJECTDIR}/Registro.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Registro.o.d" -o ${OBJECTDIR}/Registro.o Registro.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Temporizadores.o: Temporizadores.c  .generated_files/flags/default/d68e659060e10921d6432b3fc12a0bbcb0cbee85 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Temporizadores.o.d 
+	@${RM} ${OBJECTDIR}/Temporizadores.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Temporizadores.o.d" -o ${OBJECTDIR}/Temporizadores.o Temporizadores.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Sensor.o: Sensor.c  .generated_files/flags/default/94f1cf0f0ce906e140ae12b2876ac9722b450102 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Sensor.o.d 
+	@${RM} ${OBJECTDIR}/Sensor.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Sensor.o.d" -o ${OBJECTDIR}/Sensor.o Sensor.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Calendario.o: Calendario.c  .generated_files/flags/default/549b56441ad4b422b26243fb977789e744fe1c93 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Calendario.o.d 
+	@${RM} ${OBJECTDIR}/Calendario.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Calendario.o.d" -o ${OBJECTDIR}/Calendario.o Calendario.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Perfil.o: Perfil.c  .generated_files/flags/default/7fdfc13c27ba823ee1e915b743408aa7cc571cfd .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Perfil.o.d 
+	@${RM} ${OBJECTDIR}/Perfil.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Perfil.o.d" -o ${OBJECTDIR}/Perfil.o Perfil.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Retardo.o: Retardo.c  .generated_files/flags/default/e292d4d8343b4ad6d024921d7654992eba0e6ec9 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Retardo.o.d 
+	@${RM} ${OBJECTDIR}/Retardo.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Retardo.o.d" -o ${OBJECTDIR}/Retardo.o Retardo.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Planificador.o: Planificador.c  .generated_files/flags/default/9165dcec9138d479880d1612f5b2672ef118c420 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Planificador.o.d 
+	@${RM} ${OBJECTDIR}/Planificador.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Planificador.o.d" -o ${OBJECTDIR}/Planificador.o Planificador.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/SeccionCritica.o: SeccionCritica.c  .generated_files/flags/default/b2d9ad7212f29672d1d4a8c5b3516da060ecad68 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/SeccionCritica.o.d 
+	@${RM} ${OBJECTDIR}/SeccionCritica.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/SeccionCritica.o.d" -o ${OBJECTDIR}/SeccionCritica.o SeccionCritica.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/main.o: main.c  .generated_files/flags/default/510e2d9dc8f69e4adc2d0183bb4a8af5da0d45d1 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}" 
 	@${RM} ${OBJECTDIR}/main.o.d 
@@ -228,6 +306,84 @@ ${OBJECTDIR}/Uart.o: Uart.c  .generated_files/flags/default/fe98c08f17d70ebf000c
 	@${RM} ${OBJECTDIR}/Uart.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Uart.o.d" -o ${OBJECTDIR}/Uart.o Uart.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/Cola.o: Cola.c  .generated_files/flags/default/f78ffb6b739c403f12386ca68eee1fd067f6c862 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Cola.o.d 
+	@${RM} ${OBJECTDIR}/Cola.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Cola.o.d" -o ${OBJECTDIR}/Cola.o Cola.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Comandos.o: Comandos.c  .generated_files/flags/default/ca3bb9a07e92efba76c66c9b6f2ddf1462bb3778 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Comandos.o.d 
+	@${RM} ${OBJECTDIR}/Comandos.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Comandos.o.d" -o ${OBJECTDIR}/Comandos.o Comandos.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Protocolo.o: Protocolo.c  .generated_files/flags/default/367f1e30da4ef2910c8f0039863ee80691c565bb .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Protocolo.o.d 
+	@${RM} ${OBJECTDIR}/Protocolo.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Protocolo.o.d" -o ${OBJECTDIR}/Protocolo.o Protocolo.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Formato.o: Formato.c  .generated_files/flags/default/9f6309370baaa3ce81c89ad5c6021cfbfc23aca3 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Formato.o.d 
+	@${RM} ${OBJECTDIR}/Formato.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Formato.o.d" -o ${OBJECTDIR}/Formato.o Formato.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Telemetria.o: Telemetria.c  .generated_files/flags/default/61a47a55a224846598024a50659ac80830ca4159 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Telemetria.o.d 
+	@${RM} ${OBJECTDIR}/Telemetria.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Telemetria.o.d" -o ${OBJECTDIR}/Telemetria.o Telemetria.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Registro.o: Registro.c  .generated_files/flags/default/c52fa2957ff074f4a7e95cd50f584cc5a5f320ef .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Registro.o.d 
+	@${RM} ${OBJECTDIR}/Registro.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Registro.o.d" -o ${OBJECTDIR}/Registro.o Registro.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Temporizadores.o: Temporizadores.c  .generated_files/flags/default/86b56d6da176e24d810326284c21a0a06982b150 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Temporizadores.o.d 
+	@${RM} ${OBJECTDIR}/Temporizadores.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Temporizadores.o.d" -o ${OBJECTDIR}/Temporizadores.o Temporizadores.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Sensor.o: Sensor.c  .generated_files/flags/default/e81b8fcfcf45ca9680c01f6de0cb5a1a3a94019c .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Sensor.o.d 
+	@${RM} ${OBJECTDIR}/Sensor.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Sensor.o.d" -o ${OBJECTDIR}/Sensor.o Sensor.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Calendario.o: Calendario.c  .generated_files/flags/default/49dba5ff346493ba0632e1d62668371554273816 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Calendario.o.d 
+	@${RM} ${OBJECTDIR}/Calendario.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Calendario.o.d" -o ${OBJECTDIR}/Calendario.o Calendario.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Perfil.o: Perfil.c  .generated_files/flags/default/caedc51c5f82d67f445e4f2e81c3d18bbd9033fa .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Perfil.o.d 
+	@${RM} ${OBJECTDIR}/Perfil.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Perfil.o.d" -o ${OBJECTDIR}/Perfil.o Perfil.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Retardo.o: Retardo.c  .generated_files/flags/default/b46d4584cd5207f64ce8f2e497eff7baca9ebd32 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Retardo.o.d 
+	@${RM} ${OBJECTDIR}/Retardo.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Retardo.o.d" -o ${OBJECTDIR}/Retardo.o Retardo.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/Planificador.o: Planificador.c  .generated_files/flags/default/4941a3f41f0f24ec3f229fe57d608c940edee6b4 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/Planificador.o.d 
+	@${RM} ${OBJECTDIR}/Planificador.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Planificador.o.d" -o ${OBJECTDIR}/Planificador.o Planificador.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/SeccionCritica.o: SeccionCritica.c  .generated_files/flags/default/60d1e0669882b8dcadec8ea3a24b966ed14fd001 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/SeccionCritica.o.d 
+	@${RM} ${OBJECTDIR}/SeccionCritica.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/SeccionCritica.o.d" -o ${OBJECTDIR}/SeccionCritica.o SeccionCritica.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/main.o: main.c  .generated_files/flags/default/be5948391749a831ab3c01f7be282bf5680a4a34 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}" 
 	@${RM} ${OBJECTDIR}/main.o.d 